@@ -0,0 +1,85 @@
+/**
+ * Reads, tokenizes and compiles every macro-N.properties of a config
+ * directory, several times over, and reports the time per pass and the heap
+ * allocations of the last pass.
+ *
+ *     properties_bench ../bindings/.g13 [passes]
+ *
+ * Allocations are counted separately for reading + tokenizing, which should
+ * be zero once the file buffer has grown, and for MacroProgram::compile,
+ * which allocates the program's ops. File names are built before timing;
+ * the daemon's ConfigPath::getMacroPath() allocates them per load.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "Constants.h"
+#include "MacroProgram.h"
+#include "Properties.h"
+
+static size_t allocations = 0;
+
+void *operator new(size_t size) {
+    allocations++;
+    void *memory = malloc(size ? size : 1);
+    if (!memory) throw std::bad_alloc();
+    return memory;
+}
+
+void operator delete(void *memory) noexcept {
+    free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept {
+    free(memory);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <config dir> [passes]\n", argv[0]);
+        return 1;
+    }
+    int passes = argc > 2 ? atoi(argv[2]) : 100;
+    if (passes < 1) passes = 1;
+
+    std::vector<std::string> paths;
+    for (int i = 0; i < G13_MAX_MACROS; i++) {
+        paths.push_back(std::string(argv[1]) + "/macro-" + std::to_string(i) + ".properties");
+    }
+
+    std::string buffer;
+    size_t files = 0, ops = 0;
+    size_t read_allocations = 0, compile_allocations = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (int pass = 0; pass < passes; pass++) {
+        files = ops = 0;
+        read_allocations = compile_allocations = 0;
+        for (const std::string& path : paths) {
+            size_t before = allocations;
+            if (!PropertiesReader::readFile(path, &buffer)) continue;
+
+            std::string_view sequence;
+            PropertiesReader reader(buffer, path.c_str());
+            while (reader.next()) {
+                if (reader.key() == "sequence") sequence = reader.value();
+            }
+            read_allocations += allocations - before;
+
+            before = allocations;
+            ops += MacroProgram::compile(sequence).size();
+            compile_allocations += allocations - before;
+            files++;
+        }
+    }
+
+    double elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    printf("%zu files, %zu ops: %.1f us per pass\n", files, ops, elapsed / passes);
+    printf("last pass allocations: %zu reading and tokenizing, %zu compiling\n",
+           read_allocations, compile_allocations);
+    return files ? 0 : 1;
+}
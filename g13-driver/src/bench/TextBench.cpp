@@ -0,0 +1,69 @@
+/**
+ * Draws a full screen of text with LcdPage::write_text, which ORs whole
+ * font columns into the frame, and with the per-pixel renderer it replaced,
+ * then reports the time per screen of each and checks that both frames match.
+ *
+ *     text_bench [screens]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+
+#include "Constants.h"
+#include "Font.h"
+#include "LcdPage.h"
+
+#define TEXT_COLUMNS (G13_LCD_WIDTH / (FONT_WIDTH + 1))
+
+/** @brief The old renderer: one set_pixel call per lit font pixel. */
+static void write_text_per_pixel(LcdPage &page, int x, int y, const std::string& text) {
+    for (char c : text) {
+        unsigned char code = (unsigned char)c;
+        if (code < FONT_FIRST_CHAR || code > FONT_LAST_CHAR) code = ' ';
+        const uint8_t *glyph = &font_5x7[(code - FONT_FIRST_CHAR) * FONT_WIDTH];
+        for (int col = 0; col < FONT_WIDTH; col++) {
+            for (int row = 0; row < 8; row++) {
+                if (glyph[col] & (1 << row)) page.set_pixel(x + col, y + row, true);
+            }
+        }
+        x += FONT_WIDTH + 1;
+    }
+}
+
+template <typename Draw>
+static double time_screens(int screens, LcdPage &page, const std::string *lines, Draw draw) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < screens; i++) {
+        page.clear();
+        for (int row = 0; row < G13_LCD_ROWS; row++) {
+            draw(page, 0, row * 8, lines[row]);
+        }
+    }
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / screens;
+}
+
+int main(int argc, char *argv[]) {
+    int screens = argc > 1 ? atoi(argv[1]) : 100000;
+    if (screens < 1) screens = 1;
+
+    std::string lines[G13_LCD_ROWS];
+    for (int row = 0; row < G13_LCD_ROWS; row++) {
+        for (int col = 0; col < TEXT_COLUMNS; col++) {
+            lines[row] += (char)(FONT_FIRST_CHAR + (row * TEXT_COLUMNS + col) % (FONT_LAST_CHAR - FONT_FIRST_CHAR + 1));
+        }
+    }
+
+    LcdPage blitted, per_pixel;
+    double blit_us = time_screens(screens, blitted, lines,
+        [](LcdPage &page, int x, int y, const std::string& text) { page.write_text(x, y, text); });
+    double pixel_us = time_screens(screens, per_pixel, lines, write_text_per_pixel);
+
+    printf("full screen of text: %.2f us blitted, %.2f us per pixel\n", blit_us, pixel_us);
+    if (memcmp(blitted.data(), per_pixel.data(), G13_LCD_BUFFER_SIZE) != 0) {
+        printf("frames differ\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,43 @@
+#ifndef __ACTION_SLOT_H__
+#define __ACTION_SLOT_H__
+
+#include <variant>
+#include <utility>
+
+#include "G13Action.h"
+#include "PassThroughAction.h"
+#include "MacroAction.h"
+
+/**
+ * @class ActionSlot
+ * @brief Inline, cache-line sized storage for the action bound to one key.
+ *
+ * The action lives inside the slot as a std::variant (G13Action is the no-op
+ * of an unbound key), so dispatching a key transition is a std::visit on
+ * memory the slot already owns: no heap allocation per binding, no pointer
+ * chase and no virtual call.
+ */
+struct alignas(64) ActionSlot {
+    std::variant<G13Action, PassThroughAction, MacroAction> action;
+
+    /**
+     * @brief Forwards a key state to the bound action.
+     * @return 1 if the state changed, 0 otherwise.
+     */
+    int set(int state) {
+        return std::visit([state](auto& bound) { return bound.set(state); }, action);
+    }
+
+    /**
+     * @brief Replaces the bound action, constructing the new one in place.
+     * @return A reference to the new action.
+     */
+    template <typename Action, typename... Args>
+    Action& bind(Args&&... args) {
+        return action.template emplace<Action>(std::forward<Args>(args)...);
+    }
+};
+
+static_assert(sizeof(ActionSlot) == 64, "an action slot should fill exactly one cache line");
+
+#endif // __ACTION_SLOT_H__
@@ -0,0 +1,51 @@
+#include <utility>
+
+#include "ActionTable.h"
+
+ActionTable::ActionTable(std::shared_ptr<const Profile> profile, MacroScheduler& scheduler)
+    : profile(std::move(profile)) {
+    for (int key = 0; key < G13_NUM_KEYS; key++) {
+        bind(key, scheduler);
+    }
+}
+
+uint64_t ActionTable::changedSlots(const Profile& next) const {
+    uint64_t changed = 0;
+    for (int key = 0; key < G13_NUM_KEYS; key++) {
+        const Binding& before = profile->getBinding(key);
+        const Binding& after = next.getBinding(key);
+        bool same = before.type == after.type && before.code == after.code && before.repeats == after.repeats;
+
+        if (same && after.type == BINDING_MACRO) {
+            // Same macro ID: still changed if the macro file was edited.
+            auto old_program = profile->getMacro(after.code);
+            auto new_program = next.getMacro(after.code);
+            same = old_program == new_program ||
+                   (old_program && new_program && *old_program == *new_program);
+        }
+        if (!same) {
+            changed |= 1ULL << key;
+        }
+    }
+    return changed;
+}
+
+void ActionTable::bind(int key, MacroScheduler& scheduler) {
+    const Binding& binding = profile->getBinding(key);
+    switch (binding.type) {
+    case BINDING_PASSTHROUGH:
+        slots[key].bind<PassThroughAction>(binding.code);
+        break;
+    case BINDING_MACRO:
+        // A key whose macro file is missing stays unbound.
+        if (auto program = profile->getMacro(binding.code)) {
+            slots[key].bind<MacroAction>(std::move(program), scheduler).setRepeats(binding.repeats);
+            break;
+        }
+        slots[key].bind<G13Action>();
+        break;
+    default:
+        slots[key].bind<G13Action>();
+        break;
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef __ACTION_TABLE_H__
+#define __ACTION_TABLE_H__
+
+#include <array>
+#include <memory>
+
+#include "Constants.h"
+#include "ActionSlot.h"
+#include "Profile.h"
+#include "MacroScheduler.h"
+
+/**
+ * @struct ActionTable
+ * @brief The actions of one compiled Profile, one slot per key.
+ *
+ * A table is built completely before a device publishes it. A reload rebinds
+ * only the slots whose binding changed (see changedSlots()); every other slot
+ * keeps its action, including its pressed state and a running macro.
+ */
+struct ActionTable {
+    /**
+     * @brief Binds every slot from a compiled profile.
+     * @param profile The profile; kept alive for the macro programs it owns.
+     * @param scheduler Runs the delays of the table's macros.
+     */
+    ActionTable(std::shared_ptr<const Profile> profile, MacroScheduler& scheduler);
+
+    /**
+     * @brief Compares the bindings of this table's profile with another one.
+     * @return A mask with a bit set for each slot that has to be rebound.
+     */
+    uint64_t changedSlots(const Profile& next) const;
+
+    /** @brief (Re)binds one slot from the table's profile. */
+    void bind(int key, MacroScheduler& scheduler);
+
+    ActionTable(const ActionTable&) = delete;
+    ActionTable& operator=(const ActionTable&) = delete;
+
+    std::shared_ptr<const Profile> profile;
+    std::array<ActionSlot, G13_NUM_KEYS> slots;
+};
+
+#endif // __ACTION_TABLE_H__
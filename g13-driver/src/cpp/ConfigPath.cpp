@@ -1,4 +1,5 @@
 #include "ConfigPath.h"
+#include "Constants.h"
 #include <cstdlib>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -40,6 +41,23 @@ std::string ConfigPath::getConfigDir() {
     return baseDir + "/g13";
 }
 
+std::string ConfigPath::getCacheDir() {
+    const char* xdgCache = getenv("XDG_CACHE_HOME");
+    if (xdgCache && *xdgCache) {
+        return std::string(xdgCache) + "/g13";
+    }
+
+    const char* home = getenv("HOME");
+    if (!home) {
+        struct passwd* pw = getpwuid(getuid());
+        if (!pw) {
+            return "/tmp/g13-fallback/cache";
+        }
+        home = pw->pw_dir;
+    }
+    return std::string(home) + "/.cache/g13";
+}
+
 void ConfigPath::ensureConfigDirExists() {
     std::string path = getConfigDir();
     if (!dirExists(path)) {
@@ -60,12 +78,37 @@ std::string ConfigPath::getMacroPath(int macroId) {
     return getConfigDir() + "/macro-" + std::to_string(macroId) + ".properties";
 }
 
-std::string ConfigPath::getFifoPath() {
+std::string ConfigPath::getLayoutPath(const std::string& name) {
+    return getConfigDir() + "/layout-" + name + ".properties";
+}
+
+std::string ConfigPath::getBundlePath() {
+    return getConfigDir() + "/" + G13_BUNDLE_FILE;
+}
+
+std::string ConfigPath::getProfileCachePath(int bindingId) {
+    std::string path = getCacheDir();
+    if (!dirExists(path)) {
+        // ~/.cache may not exist yet on a fresh account
+        mkdir(path.substr(0, path.rfind('/')).c_str(), 0755);
+        mkdir(path.c_str(), 0755);
+    }
+    return path + "/profile-" + std::to_string(bindingId) + ".bin";
+}
+
+std::string ConfigPath::getFifoPath(int device) {
+    // The first device keeps the plain name, further ones get their index
+    std::string name = device > 0 ? "/g13-lcd-" + std::to_string(device) : "/g13-lcd";
+
     // Ideally use XDG_RUNTIME_DIR for pipes (/run/user/1000/)
     const char* xdgRuntime = getenv("XDG_RUNTIME_DIR");
     if (xdgRuntime && *xdgRuntime) {
-        return std::string(xdgRuntime) + "/g13-lcd";
+        return std::string(xdgRuntime) + name;
     }
     // Fallback to tmp
-    return "/tmp/g13-lcd";
-}
\ No newline at end of file
+    return "/tmp" + name;
+}
+
+std::string ConfigPath::getFramebufferPath(int device) {
+    return getFifoPath(device) + ".fb";
+}
@@ -27,10 +27,40 @@ public:
     static std::string getMacroPath(int macroId);
 
     /**
-     * @brief Gets the full path to the FIFO pipe.
-     * @return The absolute path (e.g., "/run/user/1000/g13-lcd" or fallback to "/tmp/g13-lcd").
+     * @brief Gets the full path to an LCD layout file (see LcdLayout).
+     * @param name The layout name.
+     * @return The absolute path (e.g., "/home/user/.config/g13/layout-monitor.properties").
      */
-    static std::string getFifoPath();
+    static std::string getLayoutPath(const std::string& name);
+
+    /**
+     * @brief Gets the full path to the packed profile bundle (see ProfileBundle).
+     * @return The absolute path (e.g., "/home/user/.config/g13/profiles.bundle").
+     */
+    static std::string getBundlePath();
+
+    /**
+     * @brief Gets the full path to the compiled image of a binding profile.
+     * Creates the cache directory if it is missing.
+     * @param bindingId The ID of the binding profile.
+     * @return The absolute path (e.g., "/home/user/.cache/g13/profile-0.bin").
+     */
+    static std::string getProfileCachePath(int bindingId);
+
+    /**
+     * @brief Gets the full path to the FIFO pipe of a device.
+     * @param device Index of the connected G13; 0 for the first one.
+     * @return The absolute path (e.g., "/run/user/1000/g13-lcd" or fallback to "/tmp/g13-lcd";
+     *         "g13-lcd-1" for the second device).
+     */
+    static std::string getFifoPath(int device);
+
+    /**
+     * @brief Gets the full path to the shared LCD framebuffer of a device (see LcdFramebuffer).
+     * @param device Index of the connected G13; 0 for the first one.
+     * @return The absolute path (e.g., "/run/user/1000/g13-lcd.fb" or fallback to "/tmp/g13-lcd.fb").
+     */
+    static std::string getFramebufferPath(int device);
 
     /**
      * @brief Ensures that the configuration directory exists.
@@ -38,12 +68,19 @@ public:
      */
     static void ensureConfigDirExists();
 
-private:
     /**
-     * @brief Internal helper to determine the user's config directory.
+     * @brief Determines the user's config directory.
      * Checks XDG_CONFIG_HOME or defaults to HOME/.config/g13.
      */
     static std::string getConfigDir();
+
+private:
+
+    /**
+     * @brief Internal helper to determine the user's cache directory.
+     * Checks XDG_CACHE_HOME or defaults to HOME/.cache/g13.
+     */
+    static std::string getCacheDir();
 };
 
 #endif // CONFIGPATH_H
\ No newline at end of file
@@ -0,0 +1,110 @@
+#include <sys/inotify.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <syslog.h> // Logging
+#include <utility>
+
+#include "ConfigWatcher.h"
+#include "ConfigPath.h"
+#include "ProfileCache.h"
+#include "MacroStore.h"
+#include "Constants.h"
+
+// Editors and the config tool either rewrite a file in place or rename a
+// temporary file over it; deletions fall back to the defaults.
+#define CONFIG_WATCH_EVENTS (IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE)
+
+ConfigWatcher::ConfigWatcher(Reactor &reactor) : reactor(reactor), inotify_fd(-1) {
+}
+
+ConfigWatcher::~ConfigWatcher() {
+    if (inotify_fd >= 0) close(inotify_fd);
+}
+
+bool ConfigWatcher::start(Callback on_profile_changed) {
+    this->on_profile_changed = std::move(on_profile_changed);
+
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd < 0) {
+        syslog(LOG_ERR, "ConfigWatcher: inotify_init1 failed: %s", strerror(errno));
+        return false;
+    }
+
+    ConfigPath::ensureConfigDirExists();
+    std::string dir = ConfigPath::getConfigDir();
+    if (inotify_add_watch(inotify_fd, dir.c_str(), CONFIG_WATCH_EVENTS) < 0) {
+        syslog(LOG_ERR, "ConfigWatcher: cannot watch %s: %s", dir.c_str(), strerror(errno));
+        stop();
+        return false;
+    }
+
+    if (!reactor.add(inotify_fd, EPOLLIN, [this](uint32_t) { read_events(); })) {
+        stop();
+        return false;
+    }
+    syslog(LOG_INFO, "Watching %s for config changes.", dir.c_str());
+    return true;
+}
+
+void ConfigWatcher::stop() {
+    if (inotify_fd < 0) return;
+    reactor.remove(inotify_fd);
+    close(inotify_fd);
+    inotify_fd = -1;
+}
+
+/**
+ * @brief Drains the inotify queue and rebuilds each affected profile once.
+ */
+void ConfigWatcher::read_events() {
+    alignas(struct inotify_event) char buffer[4096];
+    uint32_t changed = 0;
+
+    for (;;) {
+        ssize_t length = read(inotify_fd, buffer, sizeof(buffer));
+        if (length <= 0) break; // EAGAIN: queue drained
+
+        for (char *cursor = buffer; cursor < buffer + length; ) {
+            struct inotify_event *event = reinterpret_cast<struct inotify_event*>(cursor);
+            if (event->len > 0) {
+                changed |= profiles_for_file(event->name);
+            }
+            cursor += sizeof(struct inotify_event) + event->len;
+        }
+    }
+
+    for (int id = 0; id < G13_NUM_PROFILES; id++) {
+        if (changed & (1u << id)) {
+            syslog(LOG_INFO, "Config change detected. Reloading profile %d...", id);
+            on_profile_changed(id);
+        }
+    }
+}
+
+/**
+ * @brief Invalidates what depends on a config file.
+ * @return A bit mask of the profiles that need a rebuild.
+ */
+uint32_t ConfigWatcher::profiles_for_file(const char *name) {
+    if (strcmp(name, G13_BUNDLE_FILE) == 0) {
+        MacroStore::invalidateAll();
+        ProfileCache::invalidateAll();
+        return (1u << G13_NUM_PROFILES) - 1;
+    }
+
+    int id, end = 0;
+    if (sscanf(name, "bindings-%d.properties%n", &id, &end) == 1 && end > 0 && name[end] == '\0') {
+        if (id < 0 || id >= G13_NUM_PROFILES) return 0;
+        ProfileCache::invalidate(id);
+        return 1u << id;
+    }
+    end = 0;
+    if (sscanf(name, "macro-%d.properties%n", &id, &end) == 1 && end > 0 && name[end] == '\0') {
+        MacroStore::invalidate(id);
+        return ProfileCache::invalidateMacro(id);
+    }
+    return 0;
+}
@@ -0,0 +1,50 @@
+#ifndef __CONFIG_WATCHER_H__
+#define __CONFIG_WATCHER_H__
+
+#include <stdint.h>
+#include <functional>
+
+#include "Reactor.h"
+
+/**
+ * @class ConfigWatcher
+ * @brief Reloads profiles when their files in the config directory change.
+ *
+ * An inotify watch on ConfigPath::getConfigDir() is dispatched by the reactor.
+ * A changed bindings-N.properties invalidates profile N in the ProfileCache; a
+ * changed macro-M.properties invalidates the profiles that use macro M and a
+ * new or removed profile bundle invalidates everything. Only
+ * those profiles are reported, once per batch of events. Nothing is read or
+ * stat()ed while the config files stay untouched.
+ */
+class ConfigWatcher {
+public:
+    /** Called on the reactor thread with the number of a profile to rebuild. */
+    typedef std::function<void(int profile)> Callback;
+
+    explicit ConfigWatcher(Reactor &reactor);
+    ~ConfigWatcher();
+
+    ConfigWatcher(const ConfigWatcher&) = delete;
+    ConfigWatcher& operator=(const ConfigWatcher&) = delete;
+
+    /**
+     * @brief Starts watching the config directory. Reactor thread only.
+     * @param on_profile_changed Called for every profile that needs a rebuild.
+     * @return true on success, false on failure.
+     */
+    bool start(Callback on_profile_changed);
+
+    /** @brief Stops watching. Reactor thread only. */
+    void stop();
+
+private:
+    void read_events();
+    uint32_t profiles_for_file(const char *name);
+
+    Reactor &reactor;
+    int inotify_fd;
+    Callback on_profile_changed;
+};
+
+#endif // __CONFIG_WATCHER_H__
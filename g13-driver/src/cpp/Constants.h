@@ -10,7 +10,24 @@
 #define G13_PRODUCT_ID 0xc21c   // The Product ID for the G13.
 #define G13_REPORT_SIZE 8       // Size of the input report from the G13 (in bytes).
 #define G13_LCD_BUFFER_SIZE 0x3c0 // Size of the buffer for the LCD screen.
+#define G13_LCD_WIDTH 160       // LCD width in pixels.
+#define G13_LCD_HEIGHT 48       // LCD height in pixels covered by the buffer (43 are visible).
+#define G13_LCD_ROWS (G13_LCD_HEIGHT / 8) // Byte rows of 8 vertical pixels each.
+#define G13_LCD_TRANSFER_SIZE 992 // An LCD frame on the wire: 32-byte header + the buffer.
+#define G13_LCD_WRITE_TIMEOUT 1000 // Timeout for LCD frame transfers (ms).
+#define G13_LCD_WRITE_RETRIES 2 // Resends of a failed LCD frame when no newer one is waiting.
+#define G13_LCD_FIFO_READS 16   // Reads of the LCD FIFO per wakeup before the reactor moves on.
+#define G13_LCD_MAX_WIDGETS 5   // Status lines that fit on the visible part of the LCD.
+#define G13_WIDGET_ARG_SIZE 16  // Room for a widget argument such as a network interface name.
+#define G13_WIDGET_INTERVAL_MS 1000 // Refresh period of the LCD status widgets.
 #define G13_NUM_KEYS 40         // Total number of logical keys, including stick directions.
+#define G13_MAX_MACROS 200      // Macro IDs run from 0 to G13_MAX_MACROS-1.
+#define G13_NUM_PROFILES 4      // Bindings profiles, selected with the four keys under the LCD.
+#define G13_LCD_PAGES G13_NUM_PROFILES // LCD pages; each profile key shows its own page.
+#define G13_KEY_TRANSFERS 4     // Number of async key transfers kept in flight.
+#define G13_UINPUT_BATCH_SIZE 128 // Max input events written to uinput with one write().
+#define G13_BUNDLE_FILE "profiles.bundle" // Packed profiles in the config directory, used instead of the .properties files.
+#define G13_DEVICE_SCAN_MS 1000 // Interval of the fallback USB bus scan (no hotplug support).
 
 /**
  * @enum stick_mode_t
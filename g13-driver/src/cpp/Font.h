@@ -1,11 +1,14 @@
 #ifndef FONT_H
 #define FONT_H
 
-#include <vector>
 #include <cstdint>
 
-// Standard 5x7 ASCII Font (Offset 32, ASCII 32..127)
-static const std::vector<uint8_t> font_5x7 = {
+#define FONT_FIRST_CHAR 32  // First glyph in font_5x7 (space).
+#define FONT_LAST_CHAR 126  // Last glyph in font_5x7 (~).
+#define FONT_WIDTH 5        // Columns per glyph; bit n of a column is row n.
+
+// Standard 5x7 ASCII Font (Offset 32, ASCII 32..126)
+static constexpr uint8_t font_5x7[] = {
     0x00, 0x00, 0x00, 0x00, 0x00, // Space (32)
     0x00, 0x00, 0x5F, 0x00, 0x00, // !
     0x00, 0x07, 0x00, 0x07, 0x00, // "
@@ -103,4 +106,6 @@ static const std::vector<uint8_t> font_5x7 = {
     0x10, 0x08, 0x08, 0x10, 0x08  // ~
 };
 
+static_assert(sizeof(font_5x7) == (FONT_LAST_CHAR - FONT_FIRST_CHAR + 1) * FONT_WIDTH, "one glyph per printable character");
+
 #endif
\ No newline at end of file
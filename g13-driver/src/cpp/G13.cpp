@@ -16,37 +16,37 @@
 #include <istream>
 #include <chrono> 
 #include <syslog.h> 
+#include <sys/epoll.h>
 
 #include "Constants.h"
+#include "KeyMap.h"
 #include "G13.h"
-#include "G13Action.h"
-#include "PassThroughAction.h"
-#include "MacroAction.h"
+#include "ActionSlot.h"
 #include "Output.h"
-#include "Font.h"
 #include "ConfigPath.h" // NEW: Include Helper
+#include "ProfileCache.h"
 
-extern volatile sig_atomic_t daemon_keep_running;
-const int G13_MAX_MACROS = 200;
-
-std::string trim_string(const std::string& str) {
-    const std::string whitespace = " \t\n\r\f\v";
-    size_t start = str.find_first_not_of(whitespace);
-    if (start == std::string::npos) return "";
-    size_t end = str.find_last_not_of(whitespace);
-    return str.substr(start, end - start + 1);
-}
-
-G13::G13(libusb_device *device) {
+G13::G13(libusb_device *device, int index, Reactor &reactor, MacroScheduler &scheduler)
+    : reactor(reactor), scheduler(scheduler), fifo_protocol(lcd) {
     this->device = device;
+    this->device_index = index;
     this->loaded = 0;
     this->bindings = 0;
     this->stick_mode = STICK_KEYS;
-    this->last_config_mtime = 0;
-
-    actions.resize(G13_NUM_KEYS);
-    for (int i = 0; i < G13_NUM_KEYS; i++) {
-        actions[i] = std::make_unique<G13Action>();
+    this->key_transfers_in_flight = 0;
+    this->control_transfers_in_flight = 0;
+    this->disconnected = 0;
+    this->keepGoing = 0;
+    this->key_state = 0;
+    this->active_table = nullptr;
+    this->key_owner.fill(nullptr);
+    this->fifo_fd = -1;
+    this->widget_timer = -1;
+    for (int page = 0; page < G13_LCD_PAGES; page++) {
+        widgets[page] = std::make_unique<LcdWidgets>(lcd, page);
+    }
+    for (int i = 0; i < G13_KEY_TRANSFERS; i++) {
+        key_transfers[i] = nullptr;
     }
 
     if (libusb_open(device, &handle) != 0) {
@@ -72,244 +72,260 @@ G13::G13(libusb_device *device) {
         lcd_init_payload, sizeof(lcd_init_payload), 1000);
 
     setColor(128, 128, 128);
-    clear_lcd_buffer();
+    lcd.attach(handle);
     this->loaded = 1;
 
     init_fifo();
+    framebuffer.open(device_index);
 }
 
 G13::~G13() {
+    stop();
+    if (widget_timer >= 0) { // still set if start() failed after loading the bindings
+        reactor.remove_timer(widget_timer);
+    }
     cleanup_fifo(); 
+    framebuffer.close();
     if (!this->loaded) return;
+    drain_transfers();
+    for (int i = 0; i < G13_KEY_TRANSFERS; i++) {
+        libusb_free_transfer(key_transfers[i]);
+        key_transfers[i] = nullptr;
+    }
+    lcd.attach(nullptr);
     libusb_release_interface(this->handle, 0);
     libusb_close(this->handle);
 }
 
-void G13::start() {
-    if (!this->loaded) return;
+bool G13::start() {
+    if (!this->loaded) return false;
     draw_test_pattern();
     loadBindings();
     keepGoing = 1;
 
-    while (keepGoing && daemon_keep_running) {
-        check_for_config_update();
-        check_fifo();
+    // Reports are handled by key_transfer_callback() as soon as the reactor
+    // lets libusb reap them; FIFO input is dispatched by the same loop, so
+    // nothing here needs its own thread.
+    if (!submit_key_transfers()) {
+        keepGoing = 0;
+        return false;
+    }
 
-        if (read() == -4) {
-            break; 
-        }
+    if (fifo_fd >= 0) {
+        reactor.add(fifo_fd, EPOLLIN, [this](uint32_t) { check_fifo(); });
     }
+    if (framebuffer.doorbell() >= 0) {
+        reactor.add(framebuffer.doorbell(), EPOLLIN, [this](uint32_t) { check_framebuffer(); });
+    }
+    return true;
 }
 
 void G13::stop() {
-    if (!this->loaded) return;
+    if (!this->loaded || !keepGoing) return;
     keepGoing = 0;
-}
 
-// --- Live-Reload Implementation ---
-void G13::check_for_config_update() {
-    // NEW: Use ConfigPath helper
-    std::string filename = ConfigPath::getBindingPath(bindings);
-    
-    struct stat file_stat;
-    if (stat(filename.c_str(), &file_stat) == 0) {
-        if (last_config_mtime != 0 && file_stat.st_mtime > last_config_mtime) {
-            syslog(LOG_INFO, "Config file change detected. Reloading...");
-            loadBindings();
-        }
+    cancel_key_transfers();
+    if (widget_timer >= 0) {
+        reactor.remove_timer(widget_timer);
+        widget_timer = -1;
     }
+    lcd.cancel();
+    if (fifo_fd >= 0) {
+        reactor.remove(fifo_fd);
+    }
+    if (framebuffer.doorbell() >= 0) {
+        reactor.remove(framebuffer.doorbell());
+    }
+    syslog(LOG_INFO, "LCD: %llu frames sent, %llu unchanged frames skipped, %llu coalesced",
+        (unsigned long long)lcd.framesSent(), (unsigned long long)lcd.framesSkipped(),
+        (unsigned long long)lcd.framesCoalesced());
 }
 
-std::unique_ptr<Macro> G13::loadMacro(int num) {
-    // NEW: Use ConfigPath helper
-    std::string filename = ConfigPath::getMacroPath(num);
-    std::ifstream file(filename);
-
-    if (!file.is_open()) return nullptr;
-
-    auto macro = std::make_unique<Macro>();
-    macro->setId(num);
-    std::string macro_name, macro_sequence;
-
-    std::string line;
-    while (getline(file, line)) {
-        std::string trimmed_line = trim_string(line);
-        if (!trimmed_line.empty() && trimmed_line[0] != '#') {
-            size_t eq_pos = trimmed_line.find('=');
-            if (eq_pos != std::string::npos) {
-                std::string key = trim_string(trimmed_line.substr(0, eq_pos));
-                std::string value = trim_string(trimmed_line.substr(eq_pos + 1));
-                if (key == "name") macro_name = value;
-                else if (key == "sequence") macro_sequence = value;
+bool G13::isDisconnected() const {
+    return disconnected != 0;
+}
+
+int G13::deviceIndex() const {
+    return device_index;
+}
+
+// --- Async Input Pipeline ---
+bool G13::submit_key_transfers() {
+    for (int i = 0; i < G13_KEY_TRANSFERS; i++) {
+        if (!key_transfers[i]) {
+            key_transfers[i] = libusb_alloc_transfer(0);
+            if (!key_transfers[i]) {
+                syslog(LOG_ERR, "Could not allocate USB transfer");
+                break;
             }
         }
+
+        libusb_fill_interrupt_transfer(key_transfers[i], handle, LIBUSB_ENDPOINT_IN | G13_KEY_ENDPOINT,
+            key_buffers[i], G13_REPORT_SIZE, key_transfer_callback, this, G13_KEY_READ_TIMEOUT);
+
+        int error = libusb_submit_transfer(key_transfers[i]);
+        if (error) {
+            syslog(LOG_ERR, "Error submitting key transfer: %s", libusb_error_name(error));
+            break;
+        }
+        key_transfers_in_flight++;
     }
-    macro->setName(macro_name);
-    macro->setSequence(macro_sequence);
-    return macro;
+    return key_transfers_in_flight > 0;
 }
 
-void G13::parse_bindings_from_stream(std::istream& stream) {
-    // (Logic remains identical to previous version, omitted for brevity but preserved)
-    std::string line;
-    while (std::getline(stream, line)) {
-        std::string trimmed_line = trim_string(line);
-        if (trimmed_line.empty() || trimmed_line[0] == '#') continue;
-        size_t eq_pos = trimmed_line.find('=');
-        if (eq_pos == std::string::npos) continue;
-        std::string key = trim_string(trimmed_line.substr(0, eq_pos));
-        std::string value = trim_string(trimmed_line.substr(eq_pos + 1));
-
-        if (key == "color") {
-            std::stringstream ss(value);
-            std::string segment;
-            int r, g, b;
-            if (std::getline(ss, segment, ',') && (r = std::stoi(segment)) >= 0 &&
-                std::getline(ss, segment, ',') && (g = std::stoi(segment)) >= 0 &&
-                std::getline(ss, segment, ',') && (b = std::stoi(segment)) >= 0) {
-                if (r <= 255 && g <= 255 && b <= 255) setColor(r, g, b);
-            }
+void G13::cancel_key_transfers() {
+    for (int i = 0; i < G13_KEY_TRANSFERS; i++) {
+        if (key_transfers[i]) {
+            libusb_cancel_transfer(key_transfers[i]);
         }
-        else if (!key.empty() && key.rfind("G", 0) == 0) {
-            try {
-                int gKey = std::stoi(key.substr(1));
-                std::stringstream ss(value);
-                std::string type;
-                if (!std::getline(ss, type, ',')) continue;
-                type = trim_string(type);
-
-                if (type == "p") { 
-                    std::string keytype_str;
-                    if (!std::getline(ss, keytype_str, ',')) continue;
-                    keytype_str = trim_string(keytype_str);
-                    if (keytype_str.rfind("k.", 0) == 0) {
-                        int keycode = std::stoi(keytype_str.substr(2));
-                        if (gKey >= 0 && gKey < G13_NUM_KEYS) {
-                             actions[gKey] = std::make_unique<PassThroughAction>(keycode);
-                        }
-                    }
-                }
-                else if (type == "m") { 
-                    std::string macroId_str, repeats_str;
-                    if (!std::getline(ss, macroId_str, ',') || !std::getline(ss, repeats_str, ',')) continue;
-                    int macroId = std::stoi(trim_string(macroId_str));
-                    int repeats = std::stoi(trim_string(repeats_str));
-
-                    if (macroId >= 0 && macroId < G13_MAX_MACROS) {
-                        auto macro = loadMacro(macroId);
-                        if (macro && gKey >= 0 && gKey < G13_NUM_KEYS) {
-                            actions[gKey] = std::make_unique<MacroAction>(macro->getSequence());
-                            static_cast<MacroAction*>(actions[gKey].get())->setRepeats(repeats);
-                        }
-                    }
-                }
-            } catch (...) {}
+    }
+}
+
+// Lets libusb reap every outstanding transfer so none of them can call back
+// into this object once it is gone.
+void G13::drain_transfers() {
+    while (key_transfers_in_flight > 0 || control_transfers_in_flight > 0 || lcd.busy()) {
+        struct timeval tv = { 0, 100 * 1000 };
+        if (libusb_handle_events_timeout_completed(reactor.usb_context(), &tv, nullptr) == LIBUSB_ERROR_NO_DEVICE) {
+            break;
         }
     }
 }
 
-void G13::loadBindings() {
-    // NEW: Use ConfigPath helper
-    std::string filename = ConfigPath::getBindingPath(bindings);
-
-    // Update timestamp for Live-Reload
-    struct stat file_stat;
-    if (stat(filename.c_str(), &file_stat) == 0) {
-        last_config_mtime = file_stat.st_mtime;
-    }
-
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        syslog(LOG_WARNING, "Config file not found: %s. Creating defaults.", filename.c_str());
-        
-        // --- Create Default File ---
-        // If the file doesn't exist, we write the default settings to it
-        // so the user has something to edit in ~/.config/g13/
-        std::ofstream outfile(filename);
-        if (outfile.is_open()) {
-             const std::string default_bindings = R"RAW(
-# Default G13 Key Bindings
-G19=p,k.42
-G18=p,k.18
-G17=p,k.16
-G16=p,k.10
-G9=p,k.3
-G15=p,k.9
-G8=p,k.2
-G14=p,k.8
-G7=p,k.15
-G13=p,k.7
-G12=p,k.6
-G6=p,k.46
-G11=p,k.5
-G5=p,k.76
-G10=p,k.4
-G4=p,k.75
-G3=p,k.81
-G2=p,k.80
-G1=p,k.79
-G0=p,k.1
-G39=p,k.31
-color=0,0,255
-G38=p,k.32
-G37=p,k.30
-G36=p,k.17
-G35=p,k.11
-G34=p,k.72
-G33=p,k.71
-G32=p,k.62
-G31=p,k.61
-G30=p,k.60
-G29=p,k.59
-G23=p,k.58
-G22=p,k.57
-G21=p,k.57
-G20=p,k.50
-)RAW";
-            outfile << default_bindings;
-            outfile.close();
-            
-            // Now parse what we just wrote
-            std::stringstream ss(default_bindings);
-            parse_bindings_from_stream(ss);
-        } else {
-            syslog(LOG_ERR, "Could not create config file: %s", filename.c_str());
+void LIBUSB_CALL G13::key_transfer_callback(libusb_transfer *transfer) {
+    static_cast<G13*>(transfer->user_data)->on_key_transfer(transfer);
+}
+
+void LIBUSB_CALL G13::control_transfer_callback(libusb_transfer *transfer) {
+    // Buffer and transfer are released by libusb (FREE_BUFFER | FREE_TRANSFER).
+    static_cast<G13*>(transfer->user_data)->control_transfers_in_flight--;
+}
+
+void G13::on_key_transfer(libusb_transfer *transfer) {
+    switch (transfer->status) {
+    case LIBUSB_TRANSFER_COMPLETED:
+        if (transfer->actual_length == G13_REPORT_SIZE) {
+            handle_report(transfer->buffer);
         }
+        break;
+    case LIBUSB_TRANSFER_TIMED_OUT:
+        break;
+    case LIBUSB_TRANSFER_CANCELLED:
+        key_transfers_in_flight--;
+        return;
+    case LIBUSB_TRANSFER_NO_DEVICE:
+        if (!disconnected) syslog(LOG_ERR, "G13 device disconnected.");
+        disconnected = 1;
+        key_transfers_in_flight--;
+        return;
+    default:
+        syslog(LOG_ERR, "Error while reading keys: transfer status %d", transfer->status);
+        break;
     }
-    else {
-        syslog(LOG_INFO, "Loading config file: %s", filename.c_str());
-        parse_bindings_from_stream(file);
-        file.close();
+
+    // Re-arm immediately so the endpoint never runs without a queued read.
+    if (keepGoing && !disconnected && libusb_submit_transfer(transfer) == 0) {
+        return;
+    }
+    key_transfers_in_flight--;
+    if (key_transfers_in_flight == 0) {
+        disconnected = 1;
     }
 }
 
-void G13::setColor(int red, int green, int blue) {
-    unsigned char usb_data[] = { 5, (unsigned char)red, (unsigned char)green, (unsigned char)blue, 0 };
-    libusb_control_transfer(handle, LIBUSB_REQUEST_TYPE_CLASS | LIBUSB_RECIPIENT_INTERFACE, 9, 0x307, 0, usb_data, 5, 1000);
+void G13::loadBindings() {
+    // Every profile is built up front; switching later never builds anything.
+    for (int id = 0; id < G13_NUM_PROFILES; id++) {
+        tables[id] = std::make_unique<ActionTable>(ProfileCache::get(id), scheduler);
+        configure_widgets(id, tables[id]->profile->getWidgets());
+    }
+    activateProfile(bindings);
 }
 
-int G13::read() {
-    // (Existing read implementation)
-    unsigned char buffer[G13_REPORT_SIZE];
-    int size;
-    int error = libusb_interrupt_transfer(handle, LIBUSB_ENDPOINT_IN | G13_KEY_ENDPOINT, buffer, G13_REPORT_SIZE, &size, 100);
+/**
+ * @brief Applies an edited profile to its table, slot by slot.
+ *
+ * Only slots whose binding (or macro program) differs are rebound, so held
+ * keys and running macros on untouched keys carry on as if nothing happened.
+ * A held key whose binding changed is released on the old action and pressed
+ * on the new one.
+ */
+void G13::reloadProfile(int id) {
+    if (!this->loaded || !tables[id]) return;
+
+    ActionTable *table = tables[id].get();
+    std::shared_ptr<const Profile> profile = ProfileCache::get(id);
+    uint64_t changed = table->changedSlots(*profile);
+    table->profile = profile;
+
+    UInput::Batch batch;
+    int replayed = 0;
+    while (changed) {
+        int key = __builtin_ctzll(changed);
+        changed &= changed - 1;
+
+        bool held = key_owner[key] == table;
+        if (held) table->slots[key].set(0);
+        table->bind(key, scheduler);
+        if (held) replayed += table->slots[key].set(1);
+    }
+    if (replayed) {
+        UInput::send_event(EV_SYN, SYN_REPORT, 0);
+    }
+    configure_widgets(id, profile->getWidgets());
 
-    if (error == LIBUSB_ERROR_NO_DEVICE) {
-        syslog(LOG_ERR, "G13 device disconnected.");
-        return -4; 
+    if (id == bindings) {
+        activateProfile(id);
     }
-    
-    if (error && error != LIBUSB_ERROR_TIMEOUT) {
-        syslog(LOG_ERR, "Error while reading keys: %s", libusb_error_name(error));
-        return -1;
+}
+
+void G13::activateProfile(int id) {
+    bindings = id;
+    active_table.store(tables[id].get(), std::memory_order_release);
+
+    const Profile &profile = *tables[id]->profile;
+    if (profile.hasColor()) {
+        const uint8_t *color = profile.getColor();
+        setColor(color[0], color[1], color[2]);
     }
+    lcd.show(id); // re-sends the page's cached frame; nothing is redrawn
+}
 
-    if (size == G13_REPORT_SIZE) {
-        parse_joystick(buffer);
-        parse_keys(buffer);
-        UInput::send_event(EV_SYN, SYN_REPORT, 0);
+void G13::setColor(int red, int green, int blue) {
+    // Submitted asynchronously: this runs from the key callback on profile
+    // switches, where a synchronous transfer would re-enter libusb.
+    libusb_transfer *transfer = libusb_alloc_transfer(0);
+    unsigned char *usb_data = static_cast<unsigned char*>(malloc(LIBUSB_CONTROL_SETUP_SIZE + 5));
+    if (!transfer || !usb_data) {
+        libusb_free_transfer(transfer);
+        free(usb_data);
+        return;
+    }
+
+    libusb_fill_control_setup(usb_data, LIBUSB_REQUEST_TYPE_CLASS | LIBUSB_RECIPIENT_INTERFACE, 9, 0x307, 0, 5);
+    unsigned char *payload = usb_data + LIBUSB_CONTROL_SETUP_SIZE;
+    payload[0] = 5;
+    payload[1] = (unsigned char)red;
+    payload[2] = (unsigned char)green;
+    payload[3] = (unsigned char)blue;
+    payload[4] = 0;
+
+    libusb_fill_control_transfer(transfer, handle, usb_data, control_transfer_callback, this, 1000);
+    transfer->flags = LIBUSB_TRANSFER_FREE_BUFFER | LIBUSB_TRANSFER_FREE_TRANSFER;
+
+    control_transfers_in_flight++;
+    if (libusb_submit_transfer(transfer) != 0) {
+        control_transfers_in_flight--;
+        libusb_free_transfer(transfer); // FREE_BUFFER releases usb_data too
     }
-    return 0;
+}
+
+void G13::handle_report(unsigned char *buffer) {
+    // Everything this report produces leaves in a single uinput write.
+    UInput::Batch batch;
+    parse_joystick(buffer);
+    parse_keys(buffer);
+    UInput::send_event(EV_SYN, SYN_REPORT, 0);
 }
 
 void G13::parse_joystick(unsigned char *buf) {
@@ -330,148 +346,75 @@ void G13::parse_joystick(unsigned char *buf) {
         else if (stick_x >= 160) { pressed[1] = 0; pressed[2] = 1; }
         else { pressed[1] = 0; pressed[2] = 0; }
 
-        int codes[4] = {36, 37, 38, 39};
+        int codes[4] = { G13_STICK_SLOT_UP, G13_STICK_SLOT_LEFT, G13_STICK_SLOT_RIGHT, G13_STICK_SLOT_DOWN };
+        ActionTable *table = active_table.load(std::memory_order_acquire);
         for (int i = 0; i < 4; i++) {
-            if (actions[codes[i]]) actions[codes[i]]->set(pressed[i]);
+            dispatch(table, codes[i], pressed[i]);
         }
     }
 }
 
-void G13::parse_key(int key, unsigned char *byte) {
-    // (Existing implementation)
-    if (key < 0 || key >= G13_NUM_KEYS) return;
-
-    unsigned char actual_byte = byte[key / 8];
-    unsigned char mask = 1 << (key % 8);
-    int pressed = actual_byte & mask;
-
-    switch (key) {
-    case 25: case 26: case 27: case 28:
-        if (pressed) {
-            bindings = key - 25; 
-            loadBindings();
-        }
-        return;
-    case 36: case 37: case 38: case 39:
-        return;
+void G13::parse_keys(unsigned char *buf) {
+    // Bytes 3..7 hold the 40 key bits; only bits that flipped since the
+    // previous report are dispatched, so a hold-still report costs a XOR.
+    uint64_t state = (uint64_t)buf[3]
+                   | (uint64_t)buf[4] << 8
+                   | (uint64_t)buf[5] << 16
+                   | (uint64_t)buf[6] << 24
+                   | (uint64_t)buf[7] << 32;
+    uint64_t changed = state ^ key_state;
+    key_state = state;
+
+    // Roles come from G13_KEY_TABLE (KeyMap.h): action bits go straight to
+    // their slot, profile bits act on press only, everything else is dropped.
+    ActionTable *table = active_table.load(std::memory_order_acquire);
+    uint64_t action_changes = changed & G13_ACTION_KEY_MASK;
+    while (action_changes) {
+        int key = __builtin_ctzll(action_changes);
+        action_changes &= action_changes - 1;
+        dispatch(table, key, (state >> key) & 1);
     }
 
-    if (actions[key]) {
-        actions[key]->set(pressed);
+    uint64_t profile_presses = changed & state & G13_PROFILE_KEY_MASK;
+    if (profile_presses) {
+        activateProfile(G13_KEY_TABLE.arg[__builtin_ctzll(profile_presses)]);
     }
 }
 
-void G13::parse_keys(unsigned char *buf) {
-    // (Existing implementation)
-    parse_key(G13_KEY_G1, buf + 3);
-    parse_key(G13_KEY_G2, buf + 3);
-    parse_key(G13_KEY_G3, buf + 3);
-    parse_key(G13_KEY_G4, buf + 3);
-    parse_key(G13_KEY_G5, buf + 3);
-    parse_key(G13_KEY_G6, buf + 3);
-    parse_key(G13_KEY_G7, buf + 3);
-    parse_key(G13_KEY_G8, buf + 3);
-    parse_key(G13_KEY_G9, buf + 3);
-    parse_key(G13_KEY_G10, buf + 3);
-    parse_key(G13_KEY_G11, buf + 3);
-    parse_key(G13_KEY_G12, buf + 3);
-    parse_key(G13_KEY_G13, buf + 3);
-    parse_key(G13_KEY_G14, buf + 3);
-    parse_key(G13_KEY_G15, buf + 3);
-    parse_key(G13_KEY_G16, buf + 3);
-    parse_key(G13_KEY_G17, buf + 3);
-    parse_key(G13_KEY_G18, buf + 3);
-    parse_key(G13_KEY_G19, buf + 3);
-    parse_key(G13_KEY_G20, buf + 3);
-    parse_key(G13_KEY_G21, buf + 3);
-    parse_key(G13_KEY_G22, buf + 3);
-    parse_key(G13_KEY_BD, buf + 3);
-    parse_key(G13_KEY_L1, buf + 3);
-    parse_key(G13_KEY_L2, buf + 3);
-    parse_key(G13_KEY_L3, buf + 3);
-    parse_key(G13_KEY_L4, buf + 3);
-    parse_key(G13_KEY_M1, buf + 3);
-    parse_key(G13_KEY_M2, buf + 3);
-    parse_key(G13_KEY_M3, buf + 3);
-    parse_key(G13_KEY_MR, buf + 3);
-    parse_key(G13_KEY_LEFT, buf + 3);
-    parse_key(G13_KEY_DOWN, buf + 3);
-    parse_key(G13_KEY_TOP, buf + 3);
-    parse_key(G13_KEY_LIGHT, buf + 3);
-}
-
-void G13::clear_lcd_buffer() {
-    memset(this->lcd_buffer, 0, G13_LCD_BUFFER_SIZE);
-}
-
-void G13::set_pixel(int x, int y, bool on) {
-    if (x < 0 || x >= 160 || y < 0 || y >= 48) return;
-    int index = x + (y / 8) * 160;
-    int bit = y % 8;
-    if (on) this->lcd_buffer[index] |= (1 << bit);
-    else this->lcd_buffer[index] &= ~(1 << bit);
-}
-
-void G13::write_lcd() {
-    // (Existing implementation)
-    if (!this->loaded) return;
-
-    unsigned char transfer_buffer[992];
-    memset(transfer_buffer, 0, sizeof(transfer_buffer));
-    transfer_buffer[0] = 0x03; 
-
-    memcpy(transfer_buffer + 32, this->lcd_buffer, G13_LCD_BUFFER_SIZE);
-
-    int actual_length;
-    int error = libusb_interrupt_transfer(
-        this->handle, 
-        G13_LCD_ENDPOINT | LIBUSB_ENDPOINT_OUT, 
-        transfer_buffer, 
-        sizeof(transfer_buffer), 
-        &actual_length, 
-        1000 
-    );
-
-    if (error) {
-        syslog(LOG_ERR, "LCD Write Error: %s", libusb_error_name(error));
+/**
+ * @brief Routes a key state to an action table.
+ *
+ * A press goes to the active table and makes it the key's owner; the release
+ * goes to the owner even if the profile was switched meanwhile, so no key is
+ * left stuck down or released on the wrong binding.
+ */
+void G13::dispatch(ActionTable *table, int key, int pressed) {
+    ActionTable *owner = key_owner[key];
+    if (pressed) {
+        if (!owner) {
+            key_owner[key] = owner = table;
+        }
+        owner->slots[key].set(1);
+    } else if (owner) {
+        key_owner[key] = nullptr;
+        owner->slots[key].set(0);
     }
 }
 
 void G13::draw_test_pattern() {
-    clear_lcd_buffer();
-    for(int x=0; x<160; x++) { set_pixel(x, 0, true); set_pixel(x, 42, true); }
-    for(int y=0; y<43; y++) { set_pixel(0, y, true); set_pixel(159, y, true); }
-    write_text(10, 5,  "   LINUX G13 PROJECT");
-    write_text(10, 15, "  POWER of OPENSOURCE");
-    write_lcd();
+    LcdPage &page = lcd.page(lcd.visiblePage());
+    page.clear();
+    for(int x=0; x<160; x++) { page.set_pixel(x, 0, true); page.set_pixel(x, 42, true); }
+    for(int y=0; y<43; y++) { page.set_pixel(0, y, true); page.set_pixel(159, y, true); }
+    page.write_text(10, 5,  "   LINUX G13 PROJECT");
+    page.write_text(10, 15, "  POWER of OPENSOURCE");
+    lcd.present(lcd.visiblePage());
     syslog(LOG_INFO, "LCD Test Pattern sent.");
 }
 
-void G13::write_char(int x, int y, char c) {
-    // (Existing implementation)
-    if (c < 32 || c > 127) c = 32; 
-    int font_index = (c - 32) * 5;
-    for (int col = 0; col < 5; col++) {
-        uint8_t line = font_5x7[font_index + col];
-        for (int row = 0; row < 7; row++) {
-            if (line & (1 << row)) {
-                set_pixel(x + col, y + row, true);
-            }
-        }
-    }
-}
-
-void G13::write_text(int x, int y, const std::string& text) {
-    int cursor_x = x;
-    for (char c : text) {
-        write_char(cursor_x, y, c);
-        cursor_x += 6; 
-    }
-}
-
 void G13::init_fifo() {
     // NEW: Use ConfigPath helper
-    fifo_path = ConfigPath::getFifoPath();
+    fifo_path = ConfigPath::getFifoPath(device_index);
     fifo_fd = -1;
 
     unlink(fifo_path.c_str());
@@ -500,32 +443,69 @@ void G13::cleanup_fifo() {
     unlink(fifo_path.c_str());
 }
 
+/**
+ * @brief Drains the pipe and draws what arrived; the frame is flushed once per batch.
+ *
+ * Reads are capped per call so a client flooding the pipe cannot starve the
+ * key input; the descriptor stays readable and the reactor comes back to it.
+ */
 void G13::check_fifo() {
     if (fifo_fd < 0) return;
 
-    char buffer[4096];
-    ssize_t bytesRead = ::read(fifo_fd, buffer, sizeof(buffer) - 1);
+    unsigned char buffer[4096];
+    for (int i = 0; i < G13_LCD_FIFO_READS; i++) {
+        ssize_t bytesRead = ::read(fifo_fd, buffer, sizeof(buffer));
+        if (bytesRead <= 0) break;
+        fifo_protocol.feed(buffer, bytesRead);
+    }
 
-    if (bytesRead > 0) {
-        buffer[bytesRead] = '\0'; 
-        std::string input(buffer);
-        if (!input.empty() && input.back() == '\n') {
-            input.pop_back();
-        }
+    uint32_t pages = fifo_protocol.finish();
+    // Unchanged content (e.g., a monitor refreshing every second) is not resent,
+    // and pages that are not visible only update their back buffers.
+    while (pages) {
+        int page = __builtin_ctz(pages);
+        pages &= pages - 1;
+        lcd.present(page);
+        widgets[page]->invalidate(); // status widgets, if any, take the page back on their next tick
+    }
+}
 
-        clear_lcd_buffer();
-        
-        std::stringstream ss(input);
-        std::string line;
-        int y = 0;
-        int line_height = 8; 
-
-        while (std::getline(ss, line)) {
-            if (y + 7 > 48) break; 
-            write_text(2, y, line); 
-            y += line_height;
-        }
+/**
+ * @brief Applies a profile's widget list to its page and runs the timer while any page has widgets.
+ */
+void G13::configure_widgets(int page, const std::vector<LcdWidget>& list) {
+    widgets[page]->configure(list, widget_stats);
+
+    bool active = false;
+    for (auto& page_widgets : widgets) {
+        active = active || page_widgets->isActive();
+    }
+    if (active && widget_timer < 0) {
+        widget_timer = reactor.add_timer(G13_WIDGET_INTERVAL_MS, [this]() { update_widgets(); });
+    } else if (!active && widget_timer >= 0) {
+        reactor.remove_timer(widget_timer);
+        widget_timer = -1;
+    }
+}
+
+/**
+ * @brief Samples the /proc files all pages need once, then lets each page redraw.
+ */
+void G13::update_widgets() {
+    uint32_t sources = 0;
+    for (auto& page_widgets : widgets) {
+        sources |= page_widgets->getSources();
+    }
+    widget_stats.refresh(sources);
+    for (auto& page_widgets : widgets) {
+        page_widgets->update(widget_stats);
+    }
+}
 
-        write_lcd();
+void G13::check_framebuffer() {
+    int page = lcd.visiblePage();
+    if (framebuffer.ring(lcd.page(page))) {
+        lcd.present(page);
+        widgets[page]->invalidate();
     }
 }
\ No newline at end of file
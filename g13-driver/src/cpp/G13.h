@@ -3,21 +3,35 @@
 
 #include <string>
 #include <vector>
+#include <array>
 #include <memory>
 #include <map>
+#include <atomic>
 #include <istream>
 #include <libusb-1.0/libusb.h>
-#include <time.h> // For time_t
 
 #include "Constants.h"
-#include "G13Action.h"
-#include "Macro.h"
+#include "ActionTable.h"
+#include "Reactor.h"
+#include "Lcd.h"
+#include "LcdFramebuffer.h"
+#include "LcdProtocol.h"
+#include "LcdWidgets.h"
+#include "MacroScheduler.h"
 
 class G13 {
 private:
-    std::vector<std::unique_ptr<G13Action>> actions;
+    // One prebuilt table per profile. The active one is published through an
+    // atomic pointer, so a profile switch is a single store.
+    std::array<std::unique_ptr<ActionTable>, G13_NUM_PROFILES> tables;
+    std::atomic<ActionTable*> active_table;
+    // Table that received the press of each held key; the release goes there too.
+    std::array<ActionTable*, G13_NUM_KEYS> key_owner;
 
     libusb_device        *device;       
+    int                   device_index;  // Numbers the device's pipe and framebuffer files.
+    Reactor              &reactor;
+    MacroScheduler       &scheduler;
     libusb_device_handle *handle;        
     int                   uinput_file;   
 
@@ -27,46 +41,82 @@ private:
     stick_mode_t          stick_mode;    
     int                   stick_keys[4];   
     int                   bindings;      
+    uint64_t              key_state;     // Key bits of the previous report (bytes 3..7).
 
-    unsigned char lcd_buffer[G13_LCD_BUFFER_SIZE];
+    // One LCD page per profile, shown while the profile is active. Each page
+    // has its own status widgets, which keep drawing while it is hidden. All
+    // pages share one /proc sampler and one timer, running while any page
+    // has widgets.
+    Lcd lcd;
+    std::array<std::unique_ptr<LcdWidgets>, G13_LCD_PAGES> widgets;
+    ProcStats widget_stats;
+    int widget_timer;
 
-    // Feature: Live-Reload
-    time_t last_config_mtime;
-    void check_for_config_update();
+    void configure_widgets(int page, const std::vector<LcdWidget>& list);
+    void update_widgets();
+
+    // Async input pipeline: several interrupt transfers stay queued on the
+    // key endpoint and reports are parsed from the completion callback.
+    libusb_transfer      *key_transfers[G13_KEY_TRANSFERS];
+    unsigned char         key_buffers[G13_KEY_TRANSFERS][G13_REPORT_SIZE];
+    int                   key_transfers_in_flight;     // Queued key reads; none left means no input.
+    int                   control_transfers_in_flight; // Backlight color changes (setColor()).
+    int                   disconnected;
+
+    bool submit_key_transfers();
+    void cancel_key_transfers();
+    void drain_transfers();
+    void on_key_transfer(libusb_transfer *transfer);
+    static void LIBUSB_CALL key_transfer_callback(libusb_transfer *transfer);
+    static void LIBUSB_CALL control_transfer_callback(libusb_transfer *transfer);
 
     // --- Private Methods ---
-    std::unique_ptr<Macro> loadMacro(int id);
-    void parse_bindings_from_stream(std::istream& stream);
-    int  read();
+    void handle_report(unsigned char *buf);
     void parse_joystick(unsigned char *buf);
-    void parse_key(int key, unsigned char *byte);
     void parse_keys(unsigned char *buf);
+    void dispatch(ActionTable *table, int key, int pressed);
 
     // FIFO / Pipe for external input
     int fifo_fd;             // File Descriptor for the pipe
-    std::string fifo_path;   // Path to pipe (default: /tmp/g13-lcd)
+    std::string fifo_path;   // Path to pipe (default: /tmp/g13-lcd, /tmp/g13-lcd-N for further devices)
     
     void init_fifo();        // Create pipe
     void check_fifo();       // Read pipe data
     void cleanup_fifo();     // Remove pipe
+    LcdProtocol fifo_protocol; // Parses text and binary messages from the pipe
+
+    // Shared-memory framebuffer for external graphics; drawn on the visible page
+    LcdFramebuffer framebuffer;
+    void check_framebuffer();
 
 
 public:
-    G13(libusb_device *device);
+    /**
+     * @param index Lowest index not used by another connected G13; 0 keeps the
+     *              plain g13-lcd pipe and framebuffer names.
+     */
+    G13(libusb_device *device, int index, Reactor &reactor, MacroScheduler &scheduler);
     ~G13();
 
-    void start();
+    /** @brief The index the device was created with. */
+    int deviceIndex() const;
+
+    /** @brief Loads bindings and registers the device with the reactor. */
+    bool start();
+    /** @brief Cancels pending reads and unregisters from the reactor. */
     void stop();
+    /** @brief True once the device was unplugged or its reads failed for good. */
+    bool isDisconnected() const;
+    /** @brief Builds the action tables of all profiles and activates the current one. */
     void loadBindings();
+    /** @brief Rebinds the slots of one profile that changed in the ProfileCache. */
+    void reloadProfile(int id);
+    /** @brief Publishes the table of a profile as the active one, applies its color and shows its LCD page. */
+    void activateProfile(int id);
     void setColor(int r, int g, int b);
 
     // --- LCD ---
-    void clear_lcd_buffer();
-    void set_pixel(int x, int y, bool on);
-    void write_lcd();
     void draw_test_pattern();
-    void write_char(int x, int y, char c);
-    void write_text(int x, int y, const std::string& text);
 };
 
 #endif
\ No newline at end of file
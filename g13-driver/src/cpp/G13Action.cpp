@@ -21,60 +21,37 @@ G13Action::G13Action() {
 }
 
 /**
- * @brief Virtual destructor. Does nothing in the base class.
- */
-G13Action::~G13Action() {
-}
-
-/**
- * @brief Virtual method called when the key is pressed down.
- * Subclasses should override this to implement their specific action.
- */
-void G13Action::key_down() {
-	// Base implementation is a no-op.
-	// cout << "G13Action::key_down()\n";
-}
-
-/**
- * @brief Virtual method called when the key is released.
- * Subclasses should override this to implement their specific action.
- */
-void G13Action::key_up() {
-	// Base implementation is a no-op.
-	// cout << "G13Action::key_up()\n";
-}
-
-/**
- * @brief Sets the new state of the key and triggers actions if the state changed.
+ * @brief Records the new state of the key.
  * @param state The new state (0 for released, non-zero for pressed).
- * @return 1 if the state changed and an action was triggered, 0 otherwise.
+ * @return 1 if the state changed, 0 otherwise.
  *
- * This method acts as a template method. It manages the state transition
- * and calls the appropriate virtual methods (key_down or key_up).
+ * Subclasses call this from their own set() and run their key_down or
+ * key_up logic only when it reports a change.
  */
-int G13Action::set(int state) {
+int G13Action::update(int state) {
 	int s = 0;
 	if (state != 0) {
 		s = 1;
 	}
 
-	// Only trigger actions if the state has actually changed.
+	// Only report a transition if the state has actually changed.
 	if (s != pressed) {
 		pressed = s;
-
-		if (s) {
-			key_down();
-		}
-		else {
-			key_up();
-		}
-
 		return 1; // State changed.
 	}
 
 	return 0; // State did not change.
 }
 
+/**
+ * @brief Sets the new state of an unbound key; nothing is triggered.
+ * @param state The new state (0 for released, non-zero for pressed).
+ * @return 1 if the state changed, 0 otherwise.
+ */
+int G13Action::set(int state) {
+	return update(state);
+}
+
 /**
  * @brief Returns the current pressed state of the key.
  * @return 1 if pressed, 0 if released.
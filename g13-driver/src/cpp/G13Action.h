@@ -3,11 +3,12 @@
 
 /**
  * @class G13Action
- * @brief Abstract base class for all actions that can be assigned to a G13 key.
+ * @brief Base class for all actions that can be assigned to a G13 key.
  *
- * This class provides a common interface for different types of actions,
- * such as passing through a key press, executing a macro, etc. It manages
- * the pressed/released state of the key.
+ * It manages the pressed/released state of the key and, used on its own, is
+ * the no-op action of an unbound key. Actions are not polymorphic: they are
+ * stored by value in an ActionSlot and dispatched with std::visit, so every
+ * subclass provides its own non-virtual set() built on update().
  */
 class G13Action {
 private:
@@ -16,30 +17,22 @@ private:
 
 protected:
     /**
-     * @brief Virtual method executed when the key is pressed.
-     * Subclasses must implement the specific logic for this event.
-     */
-	virtual void key_down();
-
-    /**
-     * @brief Virtual method executed when the key is released.
-     * Subclasses must implement the specific logic for this event.
+     * @brief Records the new state of the key.
+     * @param state The new state (non-zero for pressed, 0 for released).
+     * @return 1 if the state changed, 0 otherwise.
      */
-	virtual void key_up();
+	int update(int state);
 
 public:
     /** @brief Default constructor. */
 	G13Action();
 
-    /** @brief Virtual destructor to ensure proper cleanup of derived classes. */
-	virtual ~G13Action();
-
     /**
-     * @brief Updates the key's state and triggers key_down/key_up if it changed.
+     * @brief Updates the key's state. The base action does nothing else.
      * @param state The new state (non-zero for pressed, 0 for released).
      * @return 1 if the state changed, 0 otherwise.
      */
-	virtual int set(int state);
+	int set(int state);
 
     /**
      * @brief Checks if the key is currently considered pressed.
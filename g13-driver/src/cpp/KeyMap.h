@@ -0,0 +1,83 @@
+#ifndef __KEY_MAP_H__
+#define __KEY_MAP_H__
+
+#include <stdint.h>
+
+#include "Constants.h"
+
+// Action slots 36..39 do not come from report bits: they are fed by the stick
+// in STICK_KEYS mode and overlay the unused bits G13_KEY_UNDEF3..MISC_TOGGLE.
+#define G13_STICK_SLOT_UP    36
+#define G13_STICK_SLOT_LEFT  37
+#define G13_STICK_SLOT_RIGHT 38
+#define G13_STICK_SLOT_DOWN  39
+
+/**
+ * @enum key_role_t
+ * @brief What a bit of the key report (or the action slot with that index) does.
+ */
+enum key_role_t : uint8_t {
+    KEY_ROLE_IGNORED = 0, // Unused bit or state flag; never dispatched.
+    KEY_ROLE_ACTION,      // Drives the G13Action bound to the slot.
+    KEY_ROLE_PROFILE,     // Selects bindings profile and LCD page `arg` when pressed.
+    KEY_ROLE_STICK,       // Stick direction slot; the report bit itself is ignored.
+    KEY_ROLE_COUNT
+};
+
+/**
+ * @brief The single place that assigns a role to each key of G13_KEYS.
+ * @param key A G13_KEYS bit offset (0 .. G13_NUM_KEYS-1).
+ */
+constexpr key_role_t key_role(int key) {
+    switch (key) {
+    case G13_KEY_UNDEF1:
+    case G13_KEY_LIGHT_STATE:
+        return KEY_ROLE_IGNORED;
+    // The four buttons under the LCD; the config tool labels them M1-M3/MR.
+    case G13_KEY_L1: case G13_KEY_L2: case G13_KEY_L3: case G13_KEY_L4:
+        return KEY_ROLE_PROFILE;
+    case G13_STICK_SLOT_UP: case G13_STICK_SLOT_LEFT:
+    case G13_STICK_SLOT_RIGHT: case G13_STICK_SLOT_DOWN:
+        return KEY_ROLE_STICK;
+    default:
+        return KEY_ROLE_ACTION;
+    }
+}
+
+/**
+ * @brief Role-specific argument: the profile number for KEY_ROLE_PROFILE keys.
+ */
+constexpr uint8_t key_role_arg(int key) {
+    return key_role(key) == KEY_ROLE_PROFILE ? key - G13_KEY_L1 : 0;
+}
+
+/**
+ * @struct KeyTable
+ * @brief Per-bit roles plus one report mask per role, generated at compile time.
+ */
+struct KeyTable {
+    key_role_t role[G13_NUM_KEYS];
+    uint8_t    arg[G13_NUM_KEYS];
+    uint64_t   mask[KEY_ROLE_COUNT];
+};
+
+constexpr KeyTable make_key_table() {
+    KeyTable table {};
+    for (int key = 0; key < G13_NUM_KEYS; key++) {
+        table.role[key] = key_role(key);
+        table.arg[key] = key_role_arg(key);
+        table.mask[table.role[key]] |= 1ULL << key;
+    }
+    return table;
+}
+
+constexpr KeyTable G13_KEY_TABLE = make_key_table();
+
+/** Report bits that drive G13Action slots directly. */
+constexpr uint64_t G13_ACTION_KEY_MASK = G13_KEY_TABLE.mask[KEY_ROLE_ACTION];
+/** Report bits that switch the bindings profile. */
+constexpr uint64_t G13_PROFILE_KEY_MASK = G13_KEY_TABLE.mask[KEY_ROLE_PROFILE];
+
+static_assert((G13_ACTION_KEY_MASK & G13_PROFILE_KEY_MASK) == 0, "key roles must not overlap");
+
+#endif // __KEY_MAP_H__
@@ -0,0 +1,163 @@
+#include <string.h>
+#include <syslog.h> // Logging
+
+#include "Lcd.h"
+
+Lcd::Lcd()
+    : handle(nullptr), transfer(nullptr), visible(0), in_flight(false), mailbox_full(false), has_sent_frame(false),
+      retries(0), sent_count(0), skipped_count(0), coalesced_count(0) {
+    memset(mailbox, 0, sizeof(mailbox));
+    memset(sent_frame, 0, sizeof(sent_frame));
+    memset(transfer_buffer, 0, sizeof(transfer_buffer));
+    transfer_buffer[0] = 0x03;
+}
+
+Lcd::~Lcd() {
+    // The owner drains the transfer (see busy()) before destroying the Lcd.
+    libusb_free_transfer(transfer);
+}
+
+void Lcd::attach(libusb_device_handle *handle) {
+    this->handle = handle;
+    has_sent_frame = false; // whatever the device shows now is unknown
+    mailbox_full = false;
+    if (handle && !transfer) {
+        transfer = libusb_alloc_transfer(0);
+        if (!transfer) {
+            syslog(LOG_ERR, "Could not allocate LCD transfer");
+            this->handle = nullptr;
+        }
+    }
+}
+
+void Lcd::cancel() {
+    mailbox_full = false;
+    if (in_flight) {
+        libusb_cancel_transfer(transfer);
+    }
+}
+
+bool Lcd::busy() const {
+    return in_flight;
+}
+
+LcdPage& Lcd::page(int index) {
+    return pages[index];
+}
+
+int Lcd::visiblePage() const {
+    return visible;
+}
+
+void Lcd::show(int index) {
+    visible = index;
+    flush(pages[index].data());
+}
+
+bool Lcd::present(int index) {
+    if (index != visible) return false; // stays in its back buffer
+    return flush(pages[index].data());
+}
+
+/**
+ * @brief Queues a frame if it differs from the last one sent (or being sent).
+ * @return true if the frame was submitted or put in the mailbox.
+ */
+bool Lcd::flush(const unsigned char *source) {
+    if (!handle) return false;
+
+    if (in_flight) {
+        // Compare with the frame on its way; the mailbox only keeps the newest.
+        // A frame counts once: either it replaced a waiting one, or nothing was waiting.
+        if (memcmp(source, transfer_buffer + 32, G13_LCD_BUFFER_SIZE) == 0) {
+            if (mailbox_full) coalesced_count++;
+            else skipped_count++;
+            mailbox_full = false;
+            return false;
+        }
+        if (mailbox_full) coalesced_count++;
+        memcpy(mailbox, source, G13_LCD_BUFFER_SIZE);
+        mailbox_full = true;
+        return true;
+    }
+
+    if (has_sent_frame && memcmp(source, sent_frame, G13_LCD_BUFFER_SIZE) == 0) {
+        skipped_count++;
+        return false;
+    }
+    submit(source);
+    return true;
+}
+
+void Lcd::submit(const unsigned char *source) {
+    memcpy(transfer_buffer + 32, source, G13_LCD_BUFFER_SIZE);
+    retries = 0;
+    send();
+}
+
+/**
+ * @brief Submits the frame in transfer_buffer.
+ */
+void Lcd::send() {
+    libusb_fill_interrupt_transfer(transfer, handle, G13_LCD_ENDPOINT | LIBUSB_ENDPOINT_OUT,
+        transfer_buffer, sizeof(transfer_buffer), transfer_callback, this, G13_LCD_WRITE_TIMEOUT);
+
+    int error = libusb_submit_transfer(transfer);
+    if (error) {
+        syslog(LOG_ERR, "LCD Write Error: %s", libusb_error_name(error));
+        has_sent_frame = false; // retry on the next flush
+        return;
+    }
+    in_flight = true;
+}
+
+void LIBUSB_CALL Lcd::transfer_callback(libusb_transfer *transfer) {
+    static_cast<Lcd*>(transfer->user_data)->on_transfer(transfer);
+}
+
+void Lcd::on_transfer(libusb_transfer *transfer) {
+    in_flight = false;
+
+    switch (transfer->status) {
+    case LIBUSB_TRANSFER_COMPLETED:
+        memcpy(sent_frame, transfer_buffer + 32, sizeof(sent_frame));
+        has_sent_frame = true;
+        sent_count++;
+        break;
+    case LIBUSB_TRANSFER_CANCELLED:
+    case LIBUSB_TRANSFER_NO_DEVICE:
+        has_sent_frame = false;
+        mailbox_full = false;
+        return;
+    default:
+        syslog(LOG_ERR, "LCD Write Error: transfer status %d", transfer->status);
+        has_sent_frame = false; // resend whatever comes next
+        // Flushes of this same frame were dropped as already on their way, so
+        // unless a newer frame waits, this one is still the newest: send it again.
+        if (!mailbox_full && retries < G13_LCD_WRITE_RETRIES) {
+            retries++;
+            send();
+            return;
+        }
+        break;
+    }
+
+    if (mailbox_full) {
+        mailbox_full = false;
+        if (!has_sent_frame || memcmp(mailbox, sent_frame, sizeof(mailbox)) != 0) {
+            submit(mailbox);
+        }
+    }
+}
+
+uint64_t Lcd::framesSent() const {
+    return sent_count;
+}
+
+uint64_t Lcd::framesSkipped() const {
+    return skipped_count;
+}
+
+uint64_t Lcd::framesCoalesced() const {
+    return coalesced_count;
+}
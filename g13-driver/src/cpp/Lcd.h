@@ -0,0 +1,99 @@
+#ifndef __LCD_H__
+#define __LCD_H__
+
+#include <stdint.h>
+#include <libusb-1.0/libusb.h>
+
+#include "Constants.h"
+#include "LcdPage.h"
+
+/**
+ * @class Lcd
+ * @brief The G13's 160x43 monochrome display and its pages.
+ *
+ * Drawing goes to one of G13_LCD_PAGES off-screen pages; one page is
+ * visible. Presenting a hidden page costs nothing, and showing a page
+ * re-sends its cached frame, so switching pages is instant and needs no
+ * redraw. Before a frame is sent, it is compared with the last frame that
+ * actually reached the device, so unchanged content (a 1 Hz monitor whose
+ * text did not change) produces no USB traffic. The endpoint only accepts
+ * whole frames; the diff decides whether a frame is sent at all.
+ *
+ * Frames go out as asynchronous interrupt transfers completed by the reactor,
+ * so a slow or stalled endpoint never blocks key input. At most one transfer
+ * is in flight; flushes made meanwhile land in a single-frame mailbox that
+ * only keeps the newest frame, so the display can lag but never build up a
+ * backlog.
+ */
+class Lcd {
+public:
+    Lcd();
+    ~Lcd();
+
+    Lcd(const Lcd&) = delete;
+    Lcd& operator=(const Lcd&) = delete;
+
+    /**
+     * @brief Sets the device the frames are sent to (nullptr detaches).
+     * Must not be called while busy().
+     */
+    void attach(libusb_device_handle *handle);
+
+    /** @brief Cancels the transfer in flight and drops the mailbox. */
+    void cancel();
+
+    /** @brief True while a transfer is in flight. */
+    bool busy() const;
+
+    /** @brief Gets a page to draw on (0 .. G13_LCD_PAGES-1). */
+    LcdPage& page(int index);
+
+    /** @brief Gets the index of the page on the display. */
+    int visiblePage() const;
+
+    /**
+     * @brief Puts a page on the display by sending its frame (skipped if already shown).
+     * Never blocks.
+     */
+    void show(int index);
+
+    /**
+     * @brief Sends a page after drawing on it, if it is the visible one.
+     * Hidden pages keep the frame as a back buffer until they are shown.
+     * @return true if a frame was submitted or put in the mailbox.
+     */
+    bool present(int index);
+
+    /** @brief Number of frames sent to the device. */
+    uint64_t framesSent() const;
+
+    /** @brief Number of flushes skipped because the frame was unchanged. */
+    uint64_t framesSkipped() const;
+
+    /** @brief Number of frames replaced in the mailbox before they were sent. */
+    uint64_t framesCoalesced() const;
+
+private:
+    bool flush(const unsigned char *source);
+    void submit(const unsigned char *source);
+    void send();
+    void on_transfer(libusb_transfer *transfer);
+    static void LIBUSB_CALL transfer_callback(libusb_transfer *transfer);
+
+    libusb_device_handle *handle;
+    libusb_transfer *transfer;
+    unsigned char transfer_buffer[G13_LCD_TRANSFER_SIZE]; // Header + frame in flight
+    LcdPage pages[G13_LCD_PAGES];                         // Back buffers; one of them is visible
+    int visible;
+    unsigned char mailbox[G13_LCD_BUFFER_SIZE];           // Newest frame waiting for the endpoint
+    unsigned char sent_frame[G13_LCD_BUFFER_SIZE];        // Last frame the device accepted
+    bool in_flight;
+    bool mailbox_full;
+    bool has_sent_frame;
+    int retries;                                          // Resends of the frame in transfer_buffer
+    uint64_t sent_count;
+    uint64_t skipped_count;
+    uint64_t coalesced_count;
+};
+
+#endif // __LCD_H__
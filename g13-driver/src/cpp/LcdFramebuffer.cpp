@@ -0,0 +1,108 @@
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <syslog.h> // Logging
+#include <new>
+
+#include "LcdFramebuffer.h"
+#include "ConfigPath.h"
+
+#define LCD_FB_FILE_SIZE (LCD_FB_HEADER_SIZE + G13_LCD_BUFFER_SIZE)
+
+LcdFramebuffer::LcdFramebuffer() : doorbell_fd(-1), header(nullptr), frame(nullptr), last_seq(0) {
+}
+
+LcdFramebuffer::~LcdFramebuffer() {
+    close();
+}
+
+bool LcdFramebuffer::open(int device) {
+    path = ConfigPath::getFramebufferPath(device);
+    doorbell_path = path + ".doorbell";
+
+    unlink(path.c_str());
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+    if (fd < 0) {
+        syslog(LOG_ERR, "Failed to create LCD framebuffer at %s: %s", path.c_str(), strerror(errno));
+        return false;
+    }
+    fchmod(fd, 0666); // not subject to the umask, same as the LCD FIFO
+
+    void *mapping = MAP_FAILED;
+    if (ftruncate(fd, LCD_FB_FILE_SIZE) == 0) {
+        mapping = mmap(nullptr, LCD_FB_FILE_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        syslog(LOG_ERR, "Failed to map LCD framebuffer: %s", strerror(errno));
+        unlink(path.c_str());
+        return false;
+    }
+
+    header = new (mapping) LcdFramebufferHeader;
+    header->magic = LCD_FB_MAGIC;
+    header->version = LCD_FB_VERSION;
+    header->header_size = LCD_FB_HEADER_SIZE;
+    header->width = G13_LCD_WIDTH;
+    header->height = G13_LCD_HEIGHT;
+    header->format = LCD_FB_FORMAT_NATIVE;
+    header->seq.store(0);
+    frame = static_cast<unsigned char*>(mapping) + LCD_FB_HEADER_SIZE;
+    last_seq = 0;
+
+    unlink(doorbell_path.c_str());
+    if (mkfifo(doorbell_path.c_str(), 0666) != 0) {
+        syslog(LOG_ERR, "Failed to create LCD doorbell at %s: %s", doorbell_path.c_str(), strerror(errno));
+        close();
+        return false;
+    }
+    chmod(doorbell_path.c_str(), 0666);
+    doorbell_fd = ::open(doorbell_path.c_str(), O_RDWR | O_NONBLOCK | O_CLOEXEC);
+    if (doorbell_fd < 0) {
+        syslog(LOG_ERR, "Failed to open LCD doorbell: %s", strerror(errno));
+        close();
+        return false;
+    }
+
+    syslog(LOG_INFO, "LCD framebuffer created at %s", path.c_str());
+    return true;
+}
+
+void LcdFramebuffer::close() {
+    if (doorbell_fd >= 0) {
+        ::close(doorbell_fd);
+        doorbell_fd = -1;
+    }
+    if (header) {
+        munmap(header, LCD_FB_FILE_SIZE);
+        header = nullptr;
+        frame = nullptr;
+        unlink(path.c_str());
+        unlink(doorbell_path.c_str());
+    }
+}
+
+int LcdFramebuffer::doorbell() const {
+    return doorbell_fd;
+}
+
+bool LcdFramebuffer::ring(LcdPage &page) {
+    char drain[64];
+    while (::read(doorbell_fd, drain, sizeof(drain)) > 0) {}
+
+    uint32_t seq = header->seq.load(std::memory_order_acquire);
+    if ((seq & 1) || seq == last_seq) return false; // being drawn, or nothing new
+
+    // The client may start the next frame while we copy; the seq lock tells.
+    unsigned char snapshot[G13_LCD_BUFFER_SIZE];
+    memcpy(snapshot, frame, sizeof(snapshot));
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (header->seq.load(std::memory_order_relaxed) != seq) return false; // the next ring brings it
+
+    last_seq = seq;
+    page.load(snapshot);
+    return true;
+}
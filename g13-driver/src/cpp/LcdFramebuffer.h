@@ -0,0 +1,83 @@
+#ifndef __LCD_FRAMEBUFFER_H__
+#define __LCD_FRAMEBUFFER_H__
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+
+#include "Constants.h"
+#include "LcdPage.h"
+
+#define LCD_FB_MAGIC        0x46333147 // "G13F"
+#define LCD_FB_VERSION      1
+#define LCD_FB_FORMAT_NATIVE 0         // G13_LCD_ROWS rows of G13_LCD_WIDTH bytes; bit n of a byte is pixel row (row * 8 + n)
+#define LCD_FB_HEADER_SIZE  64         // The frame starts here
+
+/**
+ * @struct LcdFramebufferHeader
+ * @brief Start of the shared framebuffer file; the frame follows at LCD_FB_HEADER_SIZE.
+ *
+ * `seq` is a sequence lock: a client makes it odd before drawing and even
+ * again when the frame is complete, then writes any byte to the doorbell FIFO.
+ */
+struct LcdFramebufferHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;
+    uint16_t width;
+    uint16_t height;
+    uint32_t format;
+    std::atomic<uint32_t> seq;
+};
+
+static_assert(sizeof(LcdFramebufferHeader) <= LCD_FB_HEADER_SIZE, "header must fit before the frame");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "seq is shared with other processes");
+
+/**
+ * @class LcdFramebuffer
+ * @brief A 160x48 framebuffer in shared memory that external programs draw into.
+ *
+ * The daemon maps a file in the runtime directory that clients map as well;
+ * they draw pixels in the LCD's own layout instead of sending text through
+ * the LCD FIFO. When the doorbell FIFO becomes readable the daemon takes the
+ * latest complete frame (checked with the seq lock) and copies it into the
+ * visible LCD page; the Lcd skips sending it if nothing changed.
+ */
+class LcdFramebuffer {
+public:
+    LcdFramebuffer();
+    ~LcdFramebuffer();
+
+    LcdFramebuffer(const LcdFramebuffer&) = delete;
+    LcdFramebuffer& operator=(const LcdFramebuffer&) = delete;
+
+    /**
+     * @brief Creates and maps the framebuffer file and its doorbell FIFO.
+     * @param device Index of the G13 the files belong to (see ConfigPath::getFramebufferPath).
+     * @return true on success, false on failure.
+     */
+    bool open(int device);
+
+    /** @brief Unmaps and removes both files. */
+    void close();
+
+    /** @brief The doorbell descriptor to watch for EPOLLIN, or -1. */
+    int doorbell() const;
+
+    /**
+     * @brief Drains the doorbell and copies the current frame if it is complete and new.
+     * @param page The page that receives the frame.
+     * @return true if the page was replaced and should be presented.
+     */
+    bool ring(LcdPage &page);
+
+private:
+    std::string path;
+    std::string doorbell_path;
+    int doorbell_fd;
+    LcdFramebufferHeader *header;
+    unsigned char *frame;
+    uint32_t last_seq;
+};
+
+#endif // __LCD_FRAMEBUFFER_H__
@@ -0,0 +1,172 @@
+#include <syslog.h> // Logging
+#include <algorithm>
+
+#include "LcdLayout.h"
+#include "Properties.h"
+#include "ConfigPath.h"
+
+#define LAYOUT_CELL_WIDTH  6 // glyph plus one column of spacing
+#define LAYOUT_LINE_HEIGHT 8
+#define LAYOUT_MAX_NAME    64
+
+// Layout files are parsed from here; reused between loads.
+static std::string file_buffer;
+
+/**
+ * @brief Layout names become file names, so only [A-Za-z0-9_-] is allowed.
+ */
+static bool valid_name(std::string_view name) {
+    if (name.empty() || name.size() > LAYOUT_MAX_NAME) return false;
+    for (char c : name) {
+        bool allowed = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                       c == '_' || c == '-';
+        if (!allowed) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Parses the next field as a number in [min, max].
+ */
+static bool next_number(std::string_view &rest, int min, int max, int *value) {
+    std::string_view field;
+    return PropertiesReader::nextField(rest, &field) && PropertiesReader::parseNumber(field, value) &&
+           *value >= min && *value <= max;
+}
+
+LcdLayout::LcdLayout() : drawn_page(nullptr), drawn_revision(0) {
+}
+
+bool LcdLayout::load(std::string_view layout) {
+    if (!valid_name(layout)) {
+        syslog(LOG_ERR, "LCD layout: invalid name '%.*s'", (int)layout.size(), layout.data());
+        return false;
+    }
+    std::string filename = ConfigPath::getLayoutPath(std::string(layout));
+    if (!PropertiesReader::readFile(filename, &file_buffer)) {
+        syslog(LOG_ERR, "LCD layout: cannot read %s", filename.c_str());
+        return false;
+    }
+
+    std::vector<Element> parsed;
+    PropertiesReader reader(file_buffer, filename.c_str());
+    while (reader.next()) {
+        std::string_view key = reader.key(), rest = reader.value();
+        size_t dot = key.find('.');
+        std::string_view kind = key.substr(0, dot);
+
+        Element element {};
+        element.name = std::string(dot == std::string_view::npos ? std::string_view() : key.substr(dot + 1));
+        bool valid = !element.name.empty() &&
+                     next_number(rest, 0, G13_LCD_WIDTH - 1, &element.x) &&
+                     next_number(rest, 0, G13_LCD_HEIGHT - 1, &element.y);
+
+        if (valid && kind == "text") {
+            element.type = LAYOUT_TEXT;
+            element.label = std::string(PropertiesReader::trim(rest));
+        }
+        else if (valid && kind == "field") {
+            size_t comma = rest.rfind(',');
+            element.type = LAYOUT_FIELD;
+            valid = comma != std::string_view::npos &&
+                    PropertiesReader::parseNumber(PropertiesReader::trim(rest.substr(comma + 1)), &element.width) &&
+                    element.width > 0 && element.width <= G13_LCD_WIDTH / LAYOUT_CELL_WIDTH;
+            if (valid) element.label = std::string(PropertiesReader::trim(rest.substr(0, comma)));
+        }
+        else if (valid && kind == "bar") {
+            element.type = LAYOUT_BAR;
+            valid = next_number(rest, 3, G13_LCD_WIDTH, &element.width) &&
+                    next_number(rest, 3, G13_LCD_HEIGHT, &element.height);
+        }
+        else {
+            valid = false;
+        }
+
+        if (valid) parsed.push_back(std::move(element));
+        else reader.error("invalid layout element", key);
+    }
+
+    name = std::string(layout);
+    elements = std::move(parsed);
+    drawn_page = nullptr;
+    syslog(LOG_INFO, "LCD layout '%s' loaded (%zu elements)", name.c_str(), elements.size());
+    return true;
+}
+
+void LcdLayout::unload() {
+    name.clear();
+    elements.clear();
+    drawn_page = nullptr;
+}
+
+bool LcdLayout::isActive() const {
+    return !name.empty();
+}
+
+const std::string& LcdLayout::getName() const {
+    return name;
+}
+
+void LcdLayout::draw(LcdPage &page) {
+    page.clear();
+    for (const Element& element : elements) {
+        switch (element.type) {
+        case LAYOUT_TEXT:
+        case LAYOUT_FIELD:
+            page.write_text(element.x, element.y, element.label);
+            break;
+        case LAYOUT_BAR:
+            page.fill_rect(element.x, element.y, element.width, 1);
+            page.fill_rect(element.x, element.y + element.height - 1, element.width, 1);
+            page.fill_rect(element.x, element.y, 1, element.height);
+            page.fill_rect(element.x + element.width - 1, element.y, 1, element.height);
+            break;
+        }
+        draw_value(element, page);
+    }
+    drawn_page = &page;
+    drawn_revision = page.revision();
+}
+
+bool LcdLayout::set(std::string_view field, std::string_view value, LcdPage &page) {
+    // The cached values only say what is on screen while nobody else drew there.
+    bool stale = drawn_page != &page || page.revision() != drawn_revision;
+    bool changed = false;
+    for (Element& element : elements) {
+        if (element.type == LAYOUT_TEXT || element.name != field || element.value == value) continue;
+        element.value.assign(value.data(), value.size());
+        if (!stale) draw_value(element, page);
+        changed = true;
+    }
+
+    if (stale) {
+        draw(page);
+        return true;
+    }
+    drawn_revision = page.revision();
+    return changed;
+}
+
+/**
+ * @brief Clears and redraws the value rectangle of a field or bar; nothing else.
+ */
+void LcdLayout::draw_value(const Element& element, LcdPage &page) const {
+    if (element.type == LAYOUT_FIELD) {
+        int x = element.x;
+        if (!element.label.empty()) x += (element.label.size() + 1) * LAYOUT_CELL_WIDTH;
+        page.clear_rect(x, element.y, element.width * LAYOUT_CELL_WIDTH, LAYOUT_LINE_HEIGHT);
+        page.write_text(x, element.y, element.value.substr(0, element.width));
+    }
+    else if (element.type == LAYOUT_BAR) {
+        std::string_view value = element.value;
+        if (!value.empty() && value.back() == '%') value.remove_suffix(1);
+        int number, percent = 0;
+        if (PropertiesReader::parseNumber(value, &number)) {
+            percent = std::max(0, std::min(number, 100));
+        }
+
+        int inner_width = element.width - 2;
+        page.clear_rect(element.x + 1, element.y + 1, inner_width, element.height - 2);
+        page.fill_rect(element.x + 1, element.y + 1, inner_width * percent / 100, element.height - 2);
+    }
+}
@@ -0,0 +1,83 @@
+#ifndef __LCD_LAYOUT_H__
+#define __LCD_LAYOUT_H__
+
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "LcdPage.h"
+
+/**
+ * @enum layout_element_t
+ * @brief The kinds of elements a layout file can place.
+ */
+enum layout_element_t : uint8_t {
+    LAYOUT_TEXT = 0, // text.<name>=x,y,text            Static text.
+    LAYOUT_FIELD,    // field.<name>=x,y,label,chars    A label followed by a value of up to `chars` characters.
+    LAYOUT_BAR       // bar.<name>=x,y,width,height     A framed bar filled to the value (0-100).
+};
+
+/**
+ * @class LcdLayout
+ * @brief A named screen template from layout-<name>.properties in the config directory.
+ *
+ * Selecting a layout draws its static parts once. Clients then only send
+ * "name=value" updates: each changes the elements with that name, and only
+ * their value rectangles are cleared and re-rasterized, so the cost of an
+ * update follows what changed instead of the size of the screen. A value
+ * equal to the one shown draws nothing.
+ *
+ * The layout remembers the page's revision after drawing. If anything else
+ * drew on the page since (status widgets, a frame or a clear from the FIFO,
+ * the shared framebuffer), the next update redraws the whole layout instead.
+ */
+class LcdLayout {
+public:
+    LcdLayout();
+
+    /**
+     * @brief Loads layout-<name>.properties, replacing the current layout.
+     * @return false (keeping the current layout) if the file is missing or the name is invalid.
+     */
+    bool load(std::string_view name);
+
+    /** @brief Leaves layout mode. */
+    void unload();
+
+    /** @brief True while a layout is loaded. */
+    bool isActive() const;
+
+    /** @brief Name of the loaded layout; empty when none is. */
+    const std::string& getName() const;
+
+    /** @brief Draws the whole layout with the current values over a cleared frame. */
+    void draw(LcdPage &page);
+
+    /**
+     * @brief Updates the elements called `name` and redraws their values.
+     * Redraws the whole layout if someone else drew on the page.
+     * @return true if anything was drawn.
+     */
+    bool set(std::string_view name, std::string_view value, LcdPage &page);
+
+private:
+    struct Element {
+        uint8_t     type;   // A layout_element_t.
+        int         x, y;
+        int         width;  // Characters for fields, pixels for bars.
+        int         height; // Pixels; bars only.
+        std::string name;
+        std::string label;  // Text of static text and field labels.
+        std::string value;
+    };
+
+    void draw_value(const Element& element, LcdPage &page) const;
+
+    std::string name;
+    std::vector<Element> elements;
+    const LcdPage *drawn_page;  // Page the layout was last drawn on, or nullptr.
+    uint32_t drawn_revision;    // Its revision right after that.
+};
+
+#endif // __LCD_LAYOUT_H__
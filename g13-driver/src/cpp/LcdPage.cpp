@@ -0,0 +1,117 @@
+#include <string.h>
+#include <algorithm>
+
+#include "LcdPage.h"
+#include "Font.h"
+
+LcdPage::LcdPage() : changes(0) {
+    clear();
+}
+
+const unsigned char *LcdPage::data() const {
+    return frame;
+}
+
+uint32_t LcdPage::revision() const {
+    return changes;
+}
+
+void LcdPage::clear() {
+    memset(frame, 0, sizeof(frame));
+    changes++;
+}
+
+void LcdPage::clear_rect(int x, int y, int width, int height) {
+    paint_rect(x, y, width, height, false);
+}
+
+void LcdPage::fill_rect(int x, int y, int width, int height) {
+    paint_rect(x, y, width, height, true);
+}
+
+/**
+ * @brief Sets or clears a rectangle a byte column at a time.
+ */
+void LcdPage::paint_rect(int x, int y, int width, int height, bool on) {
+    int x_end = std::min(x + width, G13_LCD_WIDTH);
+    int y_end = std::min(y + height, G13_LCD_HEIGHT);
+    x = std::max(x, 0);
+    y = std::max(y, 0);
+    if (x >= x_end || y >= y_end) return;
+    changes++;
+
+    for (int row = y / 8; row * 8 < y_end; row++) {
+        // Bits of this byte row that fall inside [y, y_end).
+        int first = std::max(y - row * 8, 0);
+        int last = std::min(y_end - row * 8, 8);
+        unsigned char bits = ((1u << last) - 1) & ~((1u << first) - 1);
+        unsigned char *line = &frame[row * G13_LCD_WIDTH];
+        for (int px = x; px < x_end; px++) {
+            if (on) line[px] |= bits;
+            else line[px] &= ~bits;
+        }
+    }
+}
+
+void LcdPage::load(const unsigned char *source) {
+    memcpy(frame, source, sizeof(frame));
+    changes++;
+}
+
+void LcdPage::blit(int x, int y, int width, int height, const unsigned char *bits) {
+    int stride = (width + 7) / 8;
+    for (int row = 0; row < height; row++) {
+        const unsigned char *line = bits + row * stride;
+        for (int col = 0; col < width; col++) {
+            set_pixel(x + col, y + row, (line[col / 8] >> (7 - col % 8)) & 1);
+        }
+    }
+}
+
+void LcdPage::set_pixel(int x, int y, bool on) {
+    if (x < 0 || x >= G13_LCD_WIDTH || y < 0 || y >= G13_LCD_HEIGHT) return;
+    changes++;
+    int index = x + (y / 8) * G13_LCD_WIDTH;
+    int bit = y % 8;
+    if (on) frame[index] |= (1 << bit);
+    else frame[index] &= ~(1 << bit);
+}
+
+/**
+ * @brief Draws a glyph by OR-ing its column bytes straight into the frame.
+ *
+ * The frame stores 8 vertical pixels per byte, like the font columns, so a
+ * glyph at an unaligned y spans two frame rows and each column becomes two
+ * shifted byte writes instead of one set_pixel() per lit pixel.
+ */
+void LcdPage::write_char(int x, int y, char c) {
+    unsigned char code = (unsigned char)c;
+    if (code < FONT_FIRST_CHAR || code > FONT_LAST_CHAR) code = ' ';
+    if (y <= -8 || y >= G13_LCD_HEIGHT) return;
+    changes++;
+
+    const uint8_t *glyph = &font_5x7[(code - FONT_FIRST_CHAR) * FONT_WIDTH];
+    int row = (y + 8) / 8 - 1; // floor(y / 8), also for y in -7..-1
+    int shift = y - row * 8;
+
+    for (int col = 0; col < FONT_WIDTH; col++) {
+        int px = x + col;
+        if (px < 0 || px >= G13_LCD_WIDTH) continue;
+
+        unsigned int bits = (unsigned int)glyph[col] << shift;
+        if (row >= 0) {
+            frame[row * G13_LCD_WIDTH + px] |= bits & 0xff;
+        }
+        if (shift && row + 1 < G13_LCD_ROWS) {
+            frame[(row + 1) * G13_LCD_WIDTH + px] |= bits >> 8;
+        }
+    }
+}
+
+void LcdPage::write_text(int x, int y, const std::string& text) {
+    int cursor_x = x;
+    for (char c : text) {
+        write_char(cursor_x, y, c);
+        cursor_x += FONT_WIDTH + 1;
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef __LCD_PAGE_H__
+#define __LCD_PAGE_H__
+
+#include <stdint.h>
+#include <string>
+
+#include "Constants.h"
+
+/**
+ * @class LcdPage
+ * @brief An off-screen 160x48 frame in the LCD's native layout.
+ *
+ * The frame stores 8 vertical pixels per byte: bit n of byte x + row * 160
+ * is the pixel (x, row * 8 + n). Drawing never touches the device; the Lcd
+ * sends a page when it is shown or presented.
+ */
+class LcdPage {
+public:
+    LcdPage();
+
+    /** @brief The frame, G13_LCD_BUFFER_SIZE bytes. */
+    const unsigned char *data() const;
+
+    /**
+     * @brief Counts the drawing calls made on the page so far.
+     * A client that remembers it after drawing can tell whether anyone drew since.
+     */
+    uint32_t revision() const;
+
+    /** @brief Clears the whole frame. */
+    void clear();
+
+    /** @brief Clears the pixels of a rectangle, clipped to the display. */
+    void clear_rect(int x, int y, int width, int height);
+
+    /** @brief Sets the pixels of a rectangle, clipped to the display. */
+    void fill_rect(int x, int y, int width, int height);
+
+    /** @brief Replaces the frame with one drawn elsewhere. */
+    void load(const unsigned char *source);
+
+    /**
+     * @brief Replaces the pixels of a rectangle with a 1-bit bitmap.
+     * @param bits height rows of (width + 7) / 8 bytes, most significant bit leftmost.
+     */
+    void blit(int x, int y, int width, int height, const unsigned char *bits);
+
+    void set_pixel(int x, int y, bool on);
+    void write_char(int x, int y, char c);
+    void write_text(int x, int y, const std::string& text);
+
+private:
+    void paint_rect(int x, int y, int width, int height, bool on);
+
+    unsigned char frame[G13_LCD_BUFFER_SIZE];
+    uint32_t changes;
+};
+
+#endif // __LCD_PAGE_H__
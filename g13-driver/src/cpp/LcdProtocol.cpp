@@ -0,0 +1,237 @@
+#include <string.h>
+#include <syslog.h> // Logging
+#include <algorithm>
+#include <string_view>
+#include <ctype.h>
+
+#include "LcdProtocol.h"
+#include "Properties.h"
+
+#define LCD_TEXT_LINE_HEIGHT 8
+#define LCD_TEXT_CELL_WIDTH  6 // glyph plus one column of spacing
+
+LcdProtocol::LcdProtocol(Lcd &lcd)
+    : lcd(lcd), layout_page(0), target_page(-1), message_length(0), discarding(false), drawn(0) {
+}
+
+void LcdProtocol::feed(const unsigned char *data, size_t length) {
+    const unsigned char *end = data + length;
+
+    while (data < end) {
+        if (message_length == 0) {
+            const unsigned char *sync = std::find(data, end, (unsigned char)LCD_MSG_SYNC);
+            if (!discarding) {
+                text.append(reinterpret_cast<const char*>(data), sync - data);
+            }
+            data = sync;
+            if (data == end) break;
+
+            if (!text.empty()) {
+                handle_text(); // text written before the message comes first
+            }
+            discarding = false;
+            message[message_length++] = *data++;
+            continue;
+        }
+
+        size_t wanted = LCD_MSG_HEADER_SIZE;
+        if (message_length >= LCD_MSG_HEADER_SIZE) {
+            wanted += message[2] | (message[3] << 8);
+        }
+        size_t count = std::min(wanted - message_length, (size_t)(end - data));
+        memcpy(message + message_length, data, count);
+        message_length += count;
+        data += count;
+
+        if (message_length == LCD_MSG_HEADER_SIZE) {
+            size_t payload = message[2] | (message[3] << 8);
+            if (payload > LCD_MSG_MAX_PAYLOAD) {
+                syslog(LOG_ERR, "LCD FIFO: message type %d is too long (%zu bytes), skipping",
+                    message[1], payload);
+                message_length = 0;
+                discarding = true; // the payload is not text either
+                continue;
+            }
+            wanted += payload;
+        }
+        if (message_length == wanted) {
+            dispatch(message[1], message + LCD_MSG_HEADER_SIZE, message_length - LCD_MSG_HEADER_SIZE);
+            message_length = 0;
+        }
+    }
+}
+
+uint32_t LcdProtocol::finish() {
+    if (!text.empty()) {
+        handle_text();
+    }
+    discarding = false;
+    target_page = -1;
+    uint32_t result = drawn;
+    drawn = 0;
+    return result;
+}
+
+/**
+ * @brief The page this client draws on.
+ */
+int LcdProtocol::current_page() const {
+    return target_page >= 0 ? target_page : lcd.visiblePage();
+}
+
+/**
+ * @brief Gets the current page for drawing and marks it as drawn.
+ */
+LcdPage& LcdProtocol::canvas() {
+    drawn |= 1u << current_page();
+    return lcd.page(current_page());
+}
+
+/**
+ * @brief Handles the text received since the last binary message.
+ */
+void LcdProtocol::handle_text() {
+    std::string_view rest(text);
+    bool fields = false; // set by "@layout <name>" for the rest of this text
+    while (!rest.empty() && rest[0] == '@') {
+        size_t newline = rest.find('\n');
+        if (!run_command(rest.substr(0, newline), &fields)) break; // not a command: plain text
+        rest = newline == std::string_view::npos ? std::string_view() : rest.substr(newline + 1);
+    }
+
+    if (fields) {
+        update_fields(rest);
+    } else if (!rest.empty()) {
+        draw_text_screen(rest);
+    }
+    text.clear();
+}
+
+/**
+ * @brief Runs an "@layout" or "@page" line.
+ * @param fields Set if the rest of the text holds field updates.
+ * @return false if the line is not a command.
+ */
+bool LcdProtocol::run_command(std::string_view line, bool *fields) {
+    size_t space = line.find_first_of(" \t\r");
+    std::string_view command = line.substr(0, space);
+    std::string_view argument = PropertiesReader::trim(line.substr(command.size()));
+
+    if (command == "@layout") {
+        select_layout(argument);
+        *fields = !argument.empty();
+    } else if (command == "@page") {
+        int index = -1;
+        if (!argument.empty() && !PropertiesReader::parseNumber(argument, &index)) {
+            syslog(LOG_ERR, "LCD FIFO: invalid page '%.*s'", (int)argument.size(), argument.data());
+            return true;
+        }
+        select_page(index);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief The original text mode: the text replaces the screen, one line per 8 pixels.
+ */
+void LcdProtocol::draw_text_screen(std::string_view screen) {
+    if (!screen.empty() && screen.back() == '\n') {
+        screen.remove_suffix(1);
+    }
+
+    LcdPage &page = canvas();
+    page.clear();
+    int y = 0;
+    while (y + 7 <= G13_LCD_HEIGHT) {
+        size_t newline = screen.find('\n');
+        page.write_text(2, y, std::string(screen.substr(0, newline)));
+        if (newline == std::string_view::npos) break;
+        screen.remove_prefix(newline + 1);
+        y += LCD_TEXT_LINE_HEIGHT;
+    }
+}
+
+void LcdProtocol::select_layout(std::string_view name) {
+    if (name.empty()) {
+        layout.unload();
+        return;
+    }
+    // Already drawn there: keep the values, set() repairs the page if it was drawn over.
+    if (layout.isActive() && layout.getName() == name && layout_page == current_page()) return;
+
+    if (!layout.load(name)) {
+        layout.unload(); // the updates that follow were meant for this layout, not the old one
+        return;
+    }
+    layout_page = current_page();
+    layout.draw(canvas());
+}
+
+void LcdProtocol::select_page(int index) {
+    if (index >= G13_LCD_PAGES) {
+        syslog(LOG_ERR, "LCD FIFO: there is no page %d", index);
+        return;
+    }
+    target_page = index < 0 ? -1 : index;
+}
+
+void LcdProtocol::update_fields(std::string_view updates) {
+    if (!layout.isActive()) {
+        syslog(LOG_ERR, "LCD FIFO: field updates without a layout, ignoring");
+        return;
+    }
+    PropertiesReader reader(updates, "LCD FIFO");
+    // Updates go to the page the layout was drawn on, even if another page is visible now.
+    while (reader.next()) {
+        if (layout.set(reader.key(), reader.value(), lcd.page(layout_page))) drawn |= 1u << layout_page;
+    }
+}
+
+void LcdProtocol::dispatch(uint8_t type, const unsigned char *payload, size_t length) {
+    switch (type) {
+    case LCD_MSG_FRAME:
+        if (length != G13_LCD_BUFFER_SIZE) break;
+        canvas().load(payload);
+        return;
+    case LCD_MSG_RECT: {
+        if (length < 4) break;
+        int width = payload[2], height = payload[3];
+        if (length != 4 + (size_t)((width + 7) / 8) * height) break;
+        canvas().blit(payload[0], payload[1], width, height, payload + 4);
+        return;
+    }
+    case LCD_MSG_TEXT: {
+        if (length < 2) break;
+        std::string line(reinterpret_cast<const char*>(payload + 2), length - 2);
+        LcdPage &page = canvas();
+        page.clear_rect(payload[0], payload[1], line.size() * LCD_TEXT_CELL_WIDTH, LCD_TEXT_LINE_HEIGHT);
+        page.write_text(payload[0], payload[1], line);
+        return;
+    }
+    case LCD_MSG_LAYOUT:
+        select_layout(std::string_view(reinterpret_cast<const char*>(payload), length));
+        return;
+    case LCD_MSG_FIELDS:
+        update_fields(std::string_view(reinterpret_cast<const char*>(payload), length));
+        return;
+    case LCD_MSG_PAGE:
+        if (length > 1) break;
+        select_page(length ? payload[0] : -1);
+        return;
+    case LCD_MSG_CLEAR:
+        if (length == 0) {
+            canvas().clear();
+        } else if (length == 4) {
+            canvas().clear_rect(payload[0], payload[1], payload[2], payload[3]);
+        } else {
+            break;
+        }
+        return;
+    default:
+        syslog(LOG_ERR, "LCD FIFO: unknown message type %d, skipping", type);
+        return;
+    }
+    syslog(LOG_ERR, "LCD FIFO: message type %d has a bad length (%zu bytes), skipping", type, length);
+}
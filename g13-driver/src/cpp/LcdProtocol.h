@@ -0,0 +1,88 @@
+#ifndef __LCD_PROTOCOL_H__
+#define __LCD_PROTOCOL_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+#include "Constants.h"
+#include "Lcd.h"
+#include "LcdLayout.h"
+
+#define LCD_MSG_SYNC        0x00 // Starts a binary message; never part of text written with echo/printf
+#define LCD_MSG_HEADER_SIZE 4    // sync, type, payload length (16 bit, little endian)
+#define LCD_MSG_MAX_PAYLOAD (4 + G13_LCD_BUFFER_SIZE) // Largest valid payload (a full-screen rectangle)
+
+/**
+ * @enum lcd_message_t
+ * @brief Binary LCD FIFO commands. Coordinates and sizes are single bytes.
+ */
+enum lcd_message_t : uint8_t {
+    LCD_MSG_FRAME = 1, // G13_LCD_BUFFER_SIZE bytes in the native frame layout (see LcdFramebuffer)
+    LCD_MSG_RECT  = 2, // x, y, w, h, then h rows of (w + 7) / 8 bytes, MSB leftmost
+    LCD_MSG_TEXT  = 3, // x, y, then the text; the character cells are cleared first
+    LCD_MSG_CLEAR = 4, // empty: whole screen; or x, y, w, h: one rectangle
+    LCD_MSG_LAYOUT = 5, // a layout name selects that LcdLayout; empty unloads it
+    LCD_MSG_FIELDS = 6, // "name=value" lines for the fields of the selected layout
+    LCD_MSG_PAGE   = 7, // one byte: draw the rest of this batch on that page; empty: on the visible page
+};
+
+/**
+ * @class LcdProtocol
+ * @brief Streaming parser for everything written to the LCD FIFO.
+ *
+ * The FIFO carries plain text (one screen per write, as echo produces) mixed
+ * with length-prefixed binary messages that start with LCD_MSG_SYNC. A binary
+ * message may arrive split over several reads or batched with others; the
+ * parser keeps the incomplete tail until the rest arrives. Messages draw into
+ * an off-screen LcdPage, and the caller presents once per batch of reads,
+ * so back-to-back frames collapse into the newest one.
+ *
+ * A text write may start with command lines:
+ * - "@layout <name>" selects an LcdLayout, and the rest of that write is
+ *   read as "name=value" updates of its fields instead of a screen. Each
+ *   update write names its layout again, so plain text from other clients
+ *   still draws a screen; re-selecting the shown layout costs nothing.
+ *   "@layout" without a name unloads it.
+ * - "@page <n>" makes the rest of the write draw on page n, shown with
+ *   profile n; "@page" alone goes back to the visible page. The choice ends
+ *   with the batch (see finish()), so it never leaks into later writes of
+ *   other clients.
+ */
+class LcdProtocol {
+public:
+    explicit LcdProtocol(Lcd &lcd);
+
+    /** @brief Parses the next chunk read from the FIFO. */
+    void feed(const unsigned char *data, size_t length);
+
+    /**
+     * @brief Ends a batch of reads: text received so far becomes a screen, and
+     * drawing goes back to the visible page.
+     * @return A bit mask of the pages drawn on since the last call.
+     */
+    uint32_t finish();
+
+private:
+    void dispatch(uint8_t type, const unsigned char *payload, size_t length);
+    void handle_text();
+    bool run_command(std::string_view line, bool *fields);
+    int current_page() const;
+    LcdPage& canvas();
+    void draw_text_screen(std::string_view screen);
+    void select_layout(std::string_view name);
+    void update_fields(std::string_view updates);
+    void select_page(int index);
+
+    Lcd &lcd;
+    LcdLayout layout;
+    int layout_page;                                      // Page the layout was drawn on
+    int target_page;                                      // Page to draw on in this batch, or -1 for the visible one
+    std::string text;                                     // Text received since the last binary message
+    unsigned char message[LCD_MSG_HEADER_SIZE + LCD_MSG_MAX_PAYLOAD]; // Binary message being assembled
+    size_t message_length;                                // Bytes of it received so far
+    bool discarding;                                      // Skipping a rejected message up to the next sync
+    uint32_t drawn;                                       // Pages drawn on in this batch
+};
+
+#endif // __LCD_PROTOCOL_H__
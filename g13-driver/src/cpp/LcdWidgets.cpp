@@ -0,0 +1,182 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "LcdWidgets.h"
+
+#define LCD_WIDGET_LINE_HEIGHT 8
+#define LCD_WIDGET_BAR_LENGTH  10
+
+// /proc files each widget type reads, indexed by lcd_widget_t.
+static const uint32_t widget_sources[WIDGET_COUNT] = {
+    0,            // WIDGET_CLOCK
+    PROC_STAT,    // WIDGET_CPU
+    PROC_MEMINFO, // WIDGET_MEMORY
+    PROC_LOADAVG, // WIDGET_LOAD
+    PROC_NETDEV,  // WIDGET_NET
+};
+
+static uint64_t monotonic_ns() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+/**
+ * @brief Formats a byte rate with a binary unit suffix, e.g. "12.3K".
+ */
+static void format_rate(char *out, size_t size, double bytes_per_second) {
+    static const char units[] = "BKMG";
+    int unit = 0;
+    while (bytes_per_second >= 1024 && unit < 3) {
+        bytes_per_second /= 1024;
+        unit++;
+    }
+    snprintf(out, size, "%.1f%c", bytes_per_second, units[unit]);
+}
+
+LcdWidgets::LcdWidgets(Lcd &lcd, int page)
+    : lcd(lcd), page(page), sources(0), redraw_all(true), last_update_ns(0) {
+}
+
+void LcdWidgets::configure(const std::vector<LcdWidget>& widgets, ProcStats &stats) {
+    bool same = widgets.size() == lines.size();
+    for (size_t i = 0; same && i < widgets.size(); i++) {
+        same = memcmp(&widgets[i], &lines[i].widget, sizeof(LcdWidget)) == 0;
+    }
+    if (same) return;
+
+    bool had_widgets = !lines.empty();
+    lines.clear();
+    sources = 0;
+    for (const LcdWidget& widget : widgets) {
+        Line line {};
+        line.widget = widget;
+        lines.push_back(line);
+        sources |= widget_sources[widget.type];
+    }
+
+    if (lines.empty()) {
+        if (had_widgets) {
+            lcd.page(page).clear(); // don't leave the last status screen behind
+            lcd.present(page);
+        }
+        return;
+    }
+
+    // Rates are measured from here; the first CPU line shows the average since boot.
+    stats.refresh(sources);
+    last_update_ns = monotonic_ns();
+    for (Line& line : lines) {
+        if (line.widget.type == WIDGET_NET) {
+            stats.netBytes(line.widget.arg, &line.previous[0], &line.previous[1]);
+        }
+    }
+    redraw_all = true;
+    update(stats);
+}
+
+bool LcdWidgets::isActive() const {
+    return !lines.empty();
+}
+
+uint32_t LcdWidgets::getSources() const {
+    return sources;
+}
+
+void LcdWidgets::invalidate() {
+    redraw_all = true;
+}
+
+void LcdWidgets::update(const ProcStats &stats) {
+    if (lines.empty()) return;
+
+    // Each page measures rates over its own interval; configure() may have
+    // restarted it between two samples.
+    uint64_t now = monotonic_ns();
+    double seconds = (now - last_update_ns) / 1e9;
+    last_update_ns = now;
+
+    LcdPage &canvas = lcd.page(page);
+    if (redraw_all) {
+        canvas.clear();
+    }
+
+    bool changed = redraw_all;
+    for (size_t i = 0; i < lines.size(); i++) {
+        char text[LCD_WIDGET_LINE_CHARS + 1];
+        format(lines[i], stats, text, seconds);
+        if (!redraw_all && strcmp(text, lines[i].text) == 0) continue;
+
+        int y = i * LCD_WIDGET_LINE_HEIGHT;
+        canvas.clear_rect(0, y, G13_LCD_WIDTH, LCD_WIDGET_LINE_HEIGHT);
+        canvas.write_text(2, y, text);
+        memcpy(lines[i].text, text, sizeof(text));
+        changed = true;
+    }
+    redraw_all = false;
+
+    if (changed) {
+        lcd.present(page); // only reaches the device while the page is visible
+    }
+}
+
+/**
+ * @brief Formats the current text of one line.
+ * @param seconds Time since the previous sample, for rates.
+ */
+void LcdWidgets::format(Line &line, const ProcStats &stats, char *text, double seconds) {
+    const size_t size = LCD_WIDGET_LINE_CHARS + 1;
+    strcpy(text, "--");
+
+    switch (line.widget.type) {
+    case WIDGET_CLOCK: {
+        time_t now = time(nullptr);
+        struct tm local;
+        localtime_r(&now, &local);
+        strftime(text, size, "TIME: %H:%M:%S", &local);
+        break;
+    }
+    case WIDGET_CPU: {
+        uint64_t busy, total;
+        if (!stats.cpuTimes(&busy, &total)) break;
+        uint64_t delta_total = total - line.previous[1];
+        int percent = delta_total ? (int)((busy - line.previous[0]) * 100 / delta_total) : 0;
+        line.previous[0] = busy;
+        line.previous[1] = total;
+
+        char bar[LCD_WIDGET_BAR_LENGTH + 1];
+        int filled = percent * LCD_WIDGET_BAR_LENGTH / 100;
+        for (int i = 0; i < LCD_WIDGET_BAR_LENGTH; i++) bar[i] = i < filled ? 'X' : '-';
+        bar[LCD_WIDGET_BAR_LENGTH] = '\0';
+        snprintf(text, size, "CPU: %3d%% [%s]", percent, bar);
+        break;
+    }
+    case WIDGET_MEMORY: {
+        uint64_t total_kb, available_kb;
+        if (!stats.memory(&total_kb, &available_kb) || !total_kb) break;
+        uint64_t used_kb = total_kb - available_kb;
+        snprintf(text, size, "RAM: %.1f/%.1fGB (%d%%)", used_kb / 1048576.0, total_kb / 1048576.0,
+            (int)(used_kb * 100 / total_kb));
+        break;
+    }
+    case WIDGET_LOAD: {
+        std::string_view averages;
+        if (!stats.loadAverages(&averages)) break;
+        snprintf(text, size, "LOAD: %.*s", (int)averages.size(), averages.data());
+        break;
+    }
+    case WIDGET_NET: {
+        uint64_t rx, tx;
+        if (!stats.netBytes(line.widget.arg, &rx, &tx)) break;
+        char down[8], up[8]; // "1023.9K"; both fit on the line with the labels
+        // Counters reset when an interface goes away; show 0 instead of a wrapped value.
+        format_rate(down, sizeof(down), rx >= line.previous[0] && seconds > 0 ? (rx - line.previous[0]) / seconds : 0);
+        format_rate(up, sizeof(up), tx >= line.previous[1] && seconds > 0 ? (tx - line.previous[1]) / seconds : 0);
+        line.previous[0] = rx;
+        line.previous[1] = tx;
+        snprintf(text, size, "NET RX %s TX %s", down, up);
+        break;
+    }
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef __LCD_WIDGETS_H__
+#define __LCD_WIDGETS_H__
+
+#include <stdint.h>
+#include <vector>
+
+#include "Constants.h"
+#include "Profile.h"
+#include "Lcd.h"
+#include "ProcStats.h"
+
+#define LCD_WIDGET_LINE_CHARS (G13_LCD_WIDTH / 6) // 6-pixel character cells per line
+
+/**
+ * @class LcdWidgets
+ * @brief Draws the status lines of a profile (clock, CPU, memory, ...) on its LCD page.
+ *
+ * The G13 samples /proc once per G13_WIDGET_INTERVAL_MS for all of its
+ * pages and hands the sample to each page's update(). Each widget formats
+ * its line into a small text buffer; only lines whose text changed are
+ * cleared and redrawn. The page is presented afterwards: while it is hidden
+ * that only updates its back buffer, and while it is visible the Lcd still
+ * skips the transfer if the frame as a whole did not change.
+ */
+class LcdWidgets {
+public:
+    /** @param page The page (0 .. G13_LCD_PAGES-1) the widgets draw on. */
+    LcdWidgets(Lcd &lcd, int page);
+
+    LcdWidgets(const LcdWidgets&) = delete;
+    LcdWidgets& operator=(const LcdWidgets&) = delete;
+
+    /**
+     * @brief Shows a profile's widgets; an empty list clears the page.
+     * Keeps the current state if the widgets did not change.
+     * @param stats The shared sampler; refreshed here so rates start from now.
+     */
+    void configure(const std::vector<LcdWidget>& widgets, ProcStats &stats);
+
+    /** @brief True if the page has widgets to update. */
+    bool isActive() const;
+
+    /** @brief The proc_source_t mask the widgets read. */
+    uint32_t getSources() const;
+
+    /** @brief Redraws the lines whose text changed in a fresh sample of getSources(). */
+    void update(const ProcStats &stats);
+
+    /** @brief Redraws every line on the next update, e.g. after someone else drew. */
+    void invalidate();
+
+private:
+    struct Line {
+        LcdWidget widget;
+        uint64_t  previous[2];                   // Counters of the last sample (CPU times, net bytes)
+        char      text[LCD_WIDGET_LINE_CHARS + 1]; // What the line shows now
+    };
+
+    void format(Line &line, const ProcStats &stats, char *text, double seconds);
+
+    Lcd &lcd;
+    int page;
+    std::vector<Line> lines;
+    uint32_t sources;     // proc_source_t mask the widgets need
+    bool redraw_all;
+    uint64_t last_update_ns;
+};
+
+#endif // __LCD_WIDGETS_H__
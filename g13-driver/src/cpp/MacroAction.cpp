@@ -1,119 +1,115 @@
 #include <string.h>
-#include <vector>
-#include <memory>
-#include <sstream>
-#include <thread>
+#include <utility>
 #include <syslog.h> // Logging
 
 #include "MacroAction.h"
 
+// A resume later than this (e.g. after suspend) re-anchors the timeline
+// instead of replaying every missed step in a burst.
+#define MACRO_MAX_LAG_NS (1000ULL * 1000000ULL)
+
 /**
- * @brief The main loop for macro execution.
+ * @brief Executes steps until the macro hits a delay, finishes or is stopped.
+ *
+ * _repeats == 0 runs the sequence once, _repeats == 1 repeats it until the key
+ * is released and _repeats > 1 runs it that many times. Between passes the
+ * macro always goes back through the scheduler so a repeating macro without
+ * delays cannot starve the reactor.
  */
-void MacroAction::execute_macro_loop() {
-    _should_stop = false;
-
-    // Case: Run Once (_repeats == 0)
-    if (_repeats == 0) {
-        for (const auto& event : _events) {
-            if (_should_stop) break; // Check interrupt
-            event->execute();
-        }
-        _is_macro_running = false;
-        return;
-    }
-
-    // Case: Repeating macros
-    int current_repeats = 0;
+void MacroAction::run_steps() {
     while (!_should_stop) {
-        for (const auto& event : _events) {
-            if (_should_stop) break;
-            event->execute();
-        }
-
-        if (_should_stop) break;
-
-        // Fixed number of repeats
-        if (_repeats > 1) {
-            current_repeats++;
-            if (current_repeats >= _repeats) {
+        if (_step == _program->size()) {
+            _iteration++;
+            if (_repeats == 0 || (_repeats > 1 && _iteration >= _repeats)) {
                 break;
             }
+            _step = 0;
+            _scheduler.schedule(this, _deadline);
+            return;
+        }
+
+        uint32_t delay;
+        _step = _program->run(_step, &delay);
+        if (delay > 0) {
+            _deadline += (uint64_t)delay * 1000000ULL;
+            _scheduler.schedule(this, _deadline);
+            return;
         }
-        // If _repeats == 1, loop continues until key_up sets _should_stop
     }
 
-    _is_macro_running = false;
+    _is_macro_running = 0;
+    log_timing();
 }
 
-std::unique_ptr<MacroAction::Event> MacroAction::tokenToEvent(const std::string& token) {
-    if (token.empty()) return nullptr;
-
-    try {
-        if (token.rfind("kd.", 0) == 0) {
-            return std::make_unique<KeyDownEvent>(std::stoi(token.substr(3)));
-        }
-        if (token.rfind("ku.", 0) == 0) {
-            return std::make_unique<KeyUpEvent>(std::stoi(token.substr(3)));
-        }
-        if (token.rfind("d.", 0) == 0) {
-            return std::make_unique<WaitEvent>(std::stoi(token.substr(2)));
-        }
-    } catch (...) {
-        syslog(LOG_ERR, "MacroAction::tokenToEvent: Error parsing token: %s", token.c_str());
+void MacroAction::resume(uint64_t deadline_ns) {
+    uint64_t now = MacroScheduler::now();
+    if (now > deadline_ns + MACRO_MAX_LAG_NS) {
+        _deadline = now;
     }
-    return nullptr;
+    run_steps();
 }
 
-MacroAction::MacroAction(const std::string& sequence)
-    : _repeats(0), _is_macro_running(false), _should_stop(false) {
+void MacroAction::stop_macro() {
+    _should_stop = 1;
+    _scheduler.cancel(this);
+    _is_macro_running = 0;
+    log_timing();
+}
 
-    std::stringstream ss(sequence);
-    std::string token;
-    while (std::getline(ss, token, ',')) {
-        if (!token.empty()) {
-            auto event = tokenToEvent(token);
-            if (event) _events.push_back(std::move(event));
-        }
-    }
+const MacroTiming *MacroAction::getTiming() const {
+    return _scheduler.timing(this);
+}
+
+void MacroAction::log_timing() const {
+    const MacroTiming *timing = getTiming();
+    if (!timing) return;
+    syslog(LOG_DEBUG, "Macro timing: %llu resumes, jitter min %lld us, mean %lld us, max %lld us",
+        (unsigned long long)timing->samples, (long long)(timing->min_ns / 1000),
+        (long long)(timing->mean_ns() / 1000), (long long)(timing->max_ns / 1000));
+}
+
+MacroAction::MacroAction(std::shared_ptr<const MacroProgram> program, MacroScheduler& scheduler)
+    : _repeats(0), _program(std::move(program)), _scheduler(scheduler), _deadline(0), _step(0),
+      _is_macro_running(0), _should_stop(0), _iteration(0) {
 }
 
 MacroAction::~MacroAction() {
-    // RAII: Ensure thread is stopped and joined before destruction
-    _should_stop = true;
-    if (_macro_thread.joinable()) {
-        _macro_thread.join();
-    }
+    // RAII: Ensure the scheduler never resumes a destroyed macro
+    _scheduler.forget(this);
+}
+
+int MacroAction::set(int state) {
+    if (!update(state)) return 0;
+
+    if (isPressed()) key_down();
+    else key_up();
+    return 1;
 }
 
 void MacroAction::key_down() {
     if (isPressed()) {
         if (_is_macro_running) {
             // Toggle behavior: Stop if running
-            _should_stop = true;
-            if (_macro_thread.joinable()) {
-                _macro_thread.join();
-            }
+            stop_macro();
             return;
         }
 
-        if (_events.empty()) return;
+        if (_program->empty()) return;
 
-        _is_macro_running = true;
-        
-        // Clean up previous thread if necessary (should be handled, but safe-guard)
-        if (_macro_thread.joinable()) {
-            _macro_thread.join();
-        }
+        _is_macro_running = 1;
+        _should_stop = 0;
+        _step = 0;
+        _iteration = 0;
+        _deadline = MacroScheduler::now(); // All deadlines are offsets from here
 
-        // Start new thread
-        _macro_thread = std::thread(&MacroAction::execute_macro_loop, this);
+        // Steps up to the first delay run right away, inside the key report.
+        run_steps();
     }
 }
 
 void MacroAction::key_up() {
-    if (_repeats == 1) {
-       _should_stop = true;
+    if (_repeats == 1 && _is_macro_running) {
+       stop_macro();
     }
 }
 
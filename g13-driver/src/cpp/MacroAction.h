@@ -1,88 +1,74 @@
 #ifndef __MACRO_ACTION_H__
 #define __MACRO_ACTION_H__
 
-#include <linux/uinput.h>
-#include <vector>
-#include <string>
-#include <memory>       
-#include <thread>
-#include <atomic>
-#include <chrono>
+#include <memory>
 
 #include "G13Action.h"
-#include "Output.h"
+#include "MacroProgram.h"
+#include "MacroScheduler.h"
 
 /**
  * @class MacroAction
  * @brief A G13Action that executes a sequence of key presses, releases, and delays.
- * * Modernized to use std::thread and std::atomic for thread safety.
+ *
+ * The sequence is compiled once into a MacroProgram, shared with the Profile
+ * it came from. Steps run on the
+ * reactor thread: key events are sent immediately and a delay
+ * hands the macro to the shared MacroScheduler, which resumes it later. No
+ * thread is created per macro or per key press.
+ *
+ * Deadlines are absolute and derived from the time the macro was started
+ * (start + sum of all delays so far), so scheduling latency never accumulates
+ * across steps or repeats.
  */
 class MacroAction : public G13Action {
 public:
-    class Event {
-    public:
-        virtual ~Event() = default;
-        virtual void execute() = 0;
-    };
-
-    class KeyDownEvent : public Event {
-    private:
-        int keycode;
-    public:
-        KeyDownEvent(int code) : keycode(code) {}
-        void execute() override {
-            UInput::send_event(EV_KEY, keycode, 1); 
-            UInput::send_event(EV_SYN, SYN_REPORT, 0);
-        }
-    };
-
-    class KeyUpEvent : public Event {
-    private:
-        int keycode;
-    public:
-        KeyUpEvent(int code) : keycode(code) {}
-        void execute() override {
-            UInput::send_event(EV_KEY, keycode, 0); 
-            UInput::send_event(EV_SYN, SYN_REPORT, 0);
-        }
-    };
+    // --- Public Methods ---
+    MacroAction(std::shared_ptr<const MacroProgram> program, MacroScheduler& scheduler);
+    ~MacroAction();
 
-    class WaitEvent : public Event {
-    private:
-        int delay_ms;
-    public:
-        WaitEvent(int delay) : delay_ms(delay) {}
-        void execute() override {
-            // Modern C++ sleep
-            std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
-        }
-    };
+    MacroAction(const MacroAction&) = delete;
+    MacroAction& operator=(const MacroAction&) = delete;
 
-    // --- Public Methods ---
-    MacroAction(const std::string& sequence);
-    virtual ~MacroAction();
+    /**
+     * @brief Updates the key's state and starts/stops the macro on a change.
+     * @return 1 if the state changed, 0 otherwise.
+     */
+    int set(int state);
 
     void setRepeats(int r);
     int getRepeats() const;
 
-protected:
-    void key_down() override;
-    void key_up() override;
+    /**
+     * @brief Called by the scheduler when a delay has elapsed.
+     * @param deadline_ns The deadline the resume was scheduled for.
+     */
+    void resume(uint64_t deadline_ns);
+
+    /** @brief Jitter counters of this macro's resumes, or nullptr if none yet. */
+    const MacroTiming *getTiming() const;
 
 private:
+    void key_down();
+    void key_up();
+
     // --- Private Methods ---
-    void execute_macro_loop();
-    std::unique_ptr<MacroAction::Event> tokenToEvent(const std::string& token);
+    void run_steps();
+    void stop_macro();
+    void log_timing() const;
 
     // --- Private Member Variables ---
-    std::vector<std::unique_ptr<Event>> _events;
-    
+    // (Ordered to keep the action small enough for one ActionSlot.)
     int _repeats;
+    std::shared_ptr<const MacroProgram> _program;
     
-    // Threading control
-    std::atomic<bool> _is_macro_running;
-    std::atomic<bool> _should_stop;
-    std::thread _macro_thread;
+    // Execution state, only touched on the reactor thread
+    MacroScheduler& _scheduler;
+    uint64_t _deadline;                 // Absolute time the current step was due
+    uint32_t _step : 30;                // Next op to execute
+    uint32_t _is_macro_running : 1;
+    uint32_t _should_stop : 1;
+    int _iteration;                     // Completed passes (for fixed repeat counts)
 };
 
 #endif // __MACRO_ACTION_H__
\ No newline at end of file
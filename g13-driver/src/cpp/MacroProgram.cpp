@@ -0,0 +1,115 @@
+#include <linux/uinput.h>
+#include <charconv>
+#include <string.h>
+#include <syslog.h> // Logging
+
+#include "MacroProgram.h"
+#include "Output.h"
+
+#define MACRO_MAX_OPERAND ((1u << 30) - 1)
+
+MacroProgram::MacroProgram() {
+}
+
+/**
+ * @brief Parses one "kd.N" / "ku.N" / "d.N" token into an op.
+ * @return true if the token was valid.
+ */
+static bool parse_token(const char *begin, const char *end, MacroOp *op) {
+    const char *number;
+    if (end - begin > 3 && begin[0] == 'k' && begin[1] == 'd' && begin[2] == '.') {
+        op->opcode = MACRO_OP_KEY_DOWN;
+        number = begin + 3;
+    } else if (end - begin > 3 && begin[0] == 'k' && begin[1] == 'u' && begin[2] == '.') {
+        op->opcode = MACRO_OP_KEY_UP;
+        number = begin + 3;
+    } else if (end - begin > 2 && begin[0] == 'd' && begin[1] == '.') {
+        op->opcode = MACRO_OP_DELAY;
+        number = begin + 2;
+    } else {
+        return false;
+    }
+
+    uint32_t value;
+    auto result = std::from_chars(number, end, value);
+    if (result.ec != std::errc() || result.ptr != end || value > MACRO_MAX_OPERAND) {
+        return false;
+    }
+    op->operand = value;
+    return true;
+}
+
+MacroProgram MacroProgram::compile(std::string_view sequence) {
+    MacroProgram program;
+    const char *cursor = sequence.data();
+    const char *end = cursor + sequence.size();
+
+    while (cursor < end) {
+        const char *comma = cursor;
+        while (comma < end && *comma != ',') comma++;
+
+        if (comma > cursor) {
+            MacroOp op;
+            if (!parse_token(cursor, comma, &op)) {
+                syslog(LOG_ERR, "MacroProgram: Error parsing token: %.*s", (int)(comma - cursor), cursor);
+            } else if (op.opcode == MACRO_OP_DELAY) {
+                if (op.operand == 0) {
+                    // Nothing to wait for.
+                } else if (!program.ops.empty() && program.ops.back().opcode == MACRO_OP_DELAY &&
+                           (uint32_t)program.ops.back().operand + op.operand <= MACRO_MAX_OPERAND) {
+                    program.ops.back().operand += op.operand;
+                } else {
+                    program.ops.push_back(op);
+                }
+            } else {
+                program.ops.push_back(op);
+            }
+        }
+        cursor = comma + 1;
+    }
+
+    program.ops.shrink_to_fit();
+    return program;
+}
+
+MacroProgram MacroProgram::fromOps(const MacroOp *ops, uint32_t count) {
+    MacroProgram program;
+    program.ops.assign(ops, ops + count);
+    return program;
+}
+
+uint32_t MacroProgram::run(uint32_t pc, uint32_t *delay_ms) const {
+    // Key events up to the next delay are written together.
+    UInput::Batch batch;
+    uint32_t count = ops.size();
+
+    for (; pc < count; pc++) {
+        const MacroOp op = ops[pc];
+        if (op.opcode == MACRO_OP_DELAY) {
+            *delay_ms = op.operand;
+            return pc + 1;
+        }
+        UInput::send_event(EV_KEY, op.operand, op.opcode == MACRO_OP_KEY_DOWN ? 1 : 0);
+        UInput::send_event(EV_SYN, SYN_REPORT, 0);
+    }
+
+    *delay_ms = 0;
+    return pc;
+}
+
+uint32_t MacroProgram::size() const {
+    return ops.size();
+}
+
+bool MacroProgram::empty() const {
+    return ops.empty();
+}
+
+const MacroOp *MacroProgram::data() const {
+    return ops.data();
+}
+
+bool MacroProgram::operator==(const MacroProgram& other) const {
+    return ops.size() == other.ops.size() &&
+           memcmp(ops.data(), other.ops.data(), ops.size() * sizeof(MacroOp)) == 0;
+}
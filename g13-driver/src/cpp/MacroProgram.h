@@ -0,0 +1,78 @@
+#ifndef __MACRO_PROGRAM_H__
+#define __MACRO_PROGRAM_H__
+
+#include <stdint.h>
+#include <string_view>
+#include <vector>
+
+/**
+ * @enum macro_opcode_t
+ * @brief The operations a compiled macro is made of.
+ */
+enum macro_opcode_t {
+    MACRO_OP_KEY_DOWN = 0, // Press key `operand`.
+    MACRO_OP_KEY_UP,       // Release key `operand`.
+    MACRO_OP_DELAY         // Wait `operand` milliseconds.
+};
+
+/**
+ * @struct MacroOp
+ * @brief One compiled macro step packed into 4 bytes.
+ */
+struct MacroOp {
+    uint32_t opcode  : 2;  // A macro_opcode_t.
+    uint32_t operand : 30; // Keycode or delay in ms.
+};
+
+static_assert(sizeof(MacroOp) == 4, "macro ops should stay packed");
+
+/**
+ * @class MacroProgram
+ * @brief A macro sequence compiled once into a flat array of MacroOps.
+ *
+ * The "kd.N,ku.N,d.N" sequence string from macro-N.properties is parsed a
+ * single time; running the program is a loop over contiguous ops, and all key
+ * events between two delays leave in one uinput write.
+ */
+class MacroProgram {
+public:
+    MacroProgram();
+
+    /**
+     * @brief Compiles a sequence string. Malformed tokens are logged and skipped.
+     * Consecutive delays are merged and zero delays dropped.
+     */
+    static MacroProgram compile(std::string_view sequence);
+
+    /**
+     * @brief Rebuilds a program from ops that were compiled earlier (e.g., a cached profile).
+     * @param ops The compiled ops.
+     * @param count Number of ops.
+     */
+    static MacroProgram fromOps(const MacroOp *ops, uint32_t count);
+
+    /**
+     * @brief Executes ops starting at pc until a delay or the end of the program.
+     * @param pc Index of the first op to run.
+     * @param delay_ms Receives the delay that stopped execution (0 at the end).
+     * @return The index of the next op to run.
+     */
+    uint32_t run(uint32_t pc, uint32_t *delay_ms) const;
+
+    /** @brief Number of ops in the program. */
+    uint32_t size() const;
+
+    /** @brief True if the program has no ops. */
+    bool empty() const;
+
+    /** @brief True if both programs consist of the same ops. */
+    bool operator==(const MacroProgram& other) const;
+
+    /** @brief The compiled ops, size() entries. */
+    const MacroOp *data() const;
+
+private:
+    std::vector<MacroOp> ops;
+};
+
+#endif // __MACRO_PROGRAM_H__
@@ -0,0 +1,117 @@
+#include <sys/timerfd.h>
+#include <sys/epoll.h>
+#include <time.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <syslog.h>
+
+#include "MacroScheduler.h"
+#include "MacroAction.h"
+
+MacroScheduler::MacroScheduler(Reactor &reactor)
+    : reactor(reactor), timer_fd(-1), armed_deadline(0) {
+}
+
+MacroScheduler::~MacroScheduler() {
+    if (timer_fd >= 0) close(timer_fd);
+}
+
+bool MacroScheduler::init() {
+    timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timer_fd < 0) {
+        syslog(LOG_ERR, "MacroScheduler: timerfd_create failed: %s", strerror(errno));
+        return false;
+    }
+    return reactor.add(timer_fd, EPOLLIN, [this](uint32_t) { on_timer(); });
+}
+
+void MacroTiming::record(int64_t jitter_ns) {
+    if (samples == 0 || jitter_ns < min_ns) min_ns = jitter_ns;
+    if (samples == 0 || jitter_ns > max_ns) max_ns = jitter_ns;
+    total_ns += jitter_ns;
+    samples++;
+}
+
+int64_t MacroTiming::mean_ns() const {
+    return samples ? total_ns / (int64_t)samples : 0;
+}
+
+uint64_t MacroScheduler::now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+void MacroScheduler::schedule(MacroAction *macro, uint64_t deadline_ns) {
+    pending[macro] = deadline_ns;
+    queue.push({ deadline_ns, macro });
+    arm();
+}
+
+void MacroScheduler::cancel(MacroAction *macro) {
+    pending.erase(macro);
+}
+
+void MacroScheduler::forget(MacroAction *macro) {
+    pending.erase(macro);
+    timings.erase(macro);
+}
+
+const MacroTiming *MacroScheduler::timing(const MacroAction *macro) const {
+    auto it = timings.find(macro);
+    return it == timings.end() ? nullptr : &it->second;
+}
+
+bool MacroScheduler::is_live(const Entry &entry) const {
+    auto it = pending.find(entry.macro);
+    return it != pending.end() && it->second == entry.deadline;
+}
+
+/**
+ * @brief Resumes every macro whose deadline has passed, then re-arms.
+ */
+void MacroScheduler::on_timer() {
+    uint64_t expirations;
+    if (read(timer_fd, &expirations, sizeof(expirations)) < 0) {}
+    armed_deadline = 0;
+
+    // Collect first: a resumed macro may schedule itself again right away,
+    // and that must wait for the next timer expiry.
+    uint64_t current = now();
+    std::vector<Entry> due;
+    while (!queue.empty() && queue.top().deadline <= current) {
+        due.push_back(queue.top());
+        queue.pop();
+    }
+
+    for (const Entry &entry : due) {
+        if (!is_live(entry)) continue; // cancelled, possibly by an earlier resume
+        pending.erase(entry.macro);
+
+        timings[entry.macro].record((int64_t)(now() - entry.deadline));
+        entry.macro->resume(entry.deadline);
+    }
+    arm();
+}
+
+/**
+ * @brief Points the timerfd at the earliest live deadline (or disarms it).
+ */
+void MacroScheduler::arm() {
+    while (!queue.empty() && !is_live(queue.top())) {
+        queue.pop();
+    }
+
+    uint64_t deadline = queue.empty() ? 0 : queue.top().deadline;
+    if (deadline == armed_deadline) return;
+
+    // A deadline already in the past fires immediately; 0 disarms.
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    spec.it_value.tv_sec = deadline / 1000000000ULL;
+    spec.it_value.tv_nsec = deadline % 1000000000ULL;
+    if (timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &spec, nullptr) == 0) {
+        armed_deadline = deadline;
+    }
+}
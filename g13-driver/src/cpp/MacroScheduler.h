@@ -0,0 +1,99 @@
+#ifndef __MACRO_SCHEDULER_H__
+#define __MACRO_SCHEDULER_H__
+
+#include <stdint.h>
+#include <queue>
+#include <vector>
+#include <unordered_map>
+
+#include "Reactor.h"
+
+class MacroAction;
+
+/**
+ * @struct MacroTiming
+ * @brief Jitter counters for one macro: how late each resume fired.
+ */
+struct MacroTiming {
+    uint64_t samples;
+    int64_t  min_ns;
+    int64_t  max_ns;
+    int64_t  total_ns;
+
+    MacroTiming() : samples(0), min_ns(0), max_ns(0), total_ns(0) {}
+
+    /** @brief Adds one observation (actual wake-up minus deadline). */
+    void record(int64_t jitter_ns);
+
+    /** @brief Mean jitter in nanoseconds, 0 without samples. */
+    int64_t mean_ns() const;
+};
+
+/**
+ * @class MacroScheduler
+ * @brief Runs the steps of every active macro from one timerfd on the reactor.
+ *
+ * A macro runs its steps until it reaches a delay, then asks to be resumed at
+ * an absolute deadline. Pending deadlines are kept in a min-heap and the
+ * timerfd is always armed (TFD_TIMER_ABSTIME) for the earliest one, so any
+ * number of running macros costs a single descriptor and no extra threads.
+ * Every resume records its lateness in the macro's MacroTiming. All methods
+ * must be called on the reactor thread.
+ */
+class MacroScheduler {
+public:
+    MacroScheduler(Reactor &reactor);
+    ~MacroScheduler();
+
+    MacroScheduler(const MacroScheduler&) = delete;
+    MacroScheduler& operator=(const MacroScheduler&) = delete;
+
+    /**
+     * @brief Creates the timerfd and registers it with the reactor.
+     * @return true on success, false on failure.
+     */
+    bool init();
+
+    /**
+     * @brief Resumes a macro at an absolute CLOCK_MONOTONIC time.
+     * Replaces any resume already pending for the same macro.
+     * @param macro The macro whose resume() is called at the deadline.
+     * @param deadline_ns The deadline in nanoseconds (see now()).
+     */
+    void schedule(MacroAction *macro, uint64_t deadline_ns);
+
+    /** @brief Drops the pending resume of a macro, if any. */
+    void cancel(MacroAction *macro);
+
+    /** @brief Cancels and discards all state kept for a macro being destroyed. */
+    void forget(MacroAction *macro);
+
+    /** @brief Jitter counters of a macro, or nullptr if it never resumed. */
+    const MacroTiming *timing(const MacroAction *macro) const;
+
+    /** @brief The current CLOCK_MONOTONIC time in nanoseconds. */
+    static uint64_t now();
+
+private:
+    struct Entry {
+        uint64_t     deadline;
+        MacroAction *macro;
+        bool operator>(const Entry &other) const { return deadline > other.deadline; }
+    };
+
+    void on_timer();
+    void arm();
+    bool is_live(const Entry &entry) const;
+
+    Reactor &reactor;
+    int      timer_fd;
+    uint64_t armed_deadline;  // Deadline the timerfd is set to, 0 if disarmed.
+
+    // Heap entries are only live while they match `pending`; cancelled or
+    // rescheduled ones are dropped lazily when they reach the top.
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    std::unordered_map<MacroAction*, uint64_t> pending;
+    std::unordered_map<const MacroAction*, MacroTiming> timings;
+};
+
+#endif // __MACRO_SCHEDULER_H__
@@ -0,0 +1,30 @@
+#include <utility>
+
+#include "MacroStore.h"
+
+std::weak_ptr<const MacroProgram> MacroStore::programs[G13_MAX_MACROS];
+
+std::shared_ptr<const MacroProgram> MacroStore::find(int id) {
+    if (id < 0 || id >= G13_MAX_MACROS) return nullptr;
+    return programs[id].lock();
+}
+
+std::shared_ptr<const MacroProgram> MacroStore::insert(int id, MacroProgram program) {
+    auto shared = std::make_shared<const MacroProgram>(std::move(program));
+    if (id >= 0 && id < G13_MAX_MACROS) {
+        programs[id] = shared;
+    }
+    return shared;
+}
+
+void MacroStore::invalidate(int id) {
+    if (id >= 0 && id < G13_MAX_MACROS) {
+        programs[id].reset();
+    }
+}
+
+void MacroStore::invalidateAll() {
+    for (int id = 0; id < G13_MAX_MACROS; id++) {
+        programs[id].reset();
+    }
+}
@@ -0,0 +1,45 @@
+#ifndef __MACRO_STORE_H__
+#define __MACRO_STORE_H__
+
+#include <memory>
+
+#include "Constants.h"
+#include "MacroProgram.h"
+
+/**
+ * @class MacroStore
+ * @brief Process-wide registry of compiled macros, indexed by macro ID.
+ *
+ * Every profile on every device that binds macro N shares one MacroProgram,
+ * so macro-N.properties is parsed once however often it is bound. The store
+ * only keeps weak references: a program is freed together with the last
+ * profile or action that uses it.
+ *
+ * Reactor thread only.
+ */
+class MacroStore {
+public:
+    /**
+     * @brief Gets the compiled macro with an ID if something still uses it.
+     * @param id The macro ID (0 .. G13_MAX_MACROS-1).
+     * @return The shared program, or nullptr if it has to be compiled.
+     */
+    static std::shared_ptr<const MacroProgram> find(int id);
+
+    /**
+     * @brief Publishes a freshly compiled macro.
+     * @return The shared program, as later returned by find().
+     */
+    static std::shared_ptr<const MacroProgram> insert(int id, MacroProgram program);
+
+    /** @brief Forgets a macro whose file changed, so find() no longer returns it. */
+    static void invalidate(int id);
+
+    /** @brief Forgets all macros (e.g., when the profile bundle was replaced). */
+    static void invalidateAll();
+
+private:
+    static std::weak_ptr<const MacroProgram> programs[G13_MAX_MACROS];
+};
+
+#endif // __MACRO_STORE_H__
@@ -7,7 +7,7 @@
 #include <cstdlib>
 #include <unistd.h>
 #include <thread>
-#include <mutex>
+#include <memory>
 #include <libusb-1.0/libusb.h>
 #include <iomanip>
 #include <libgen.h> 
@@ -20,15 +20,27 @@
 
 #include "G13.h"
 #include "Output.h"
+#include "Reactor.h"
+#include "MacroScheduler.h"
+#include "ProfileCache.h"
+#include "ConfigWatcher.h"
+#include "ConfigPath.h"
+#include "ProfileBundle.h"
 
 // --- Global Variables ---
-std::mutex g13_map_mutex;
-std::map<uint16_t, std::thread> g13_instances;
+// Devices are created, driven and destroyed on the reactor thread only.
+std::map<uint16_t, std::unique_ptr<G13>> g13_instances;
 volatile sig_atomic_t daemon_keep_running = 1;
 
 AppIndicator *indicator = NULL;
 libusb_context *ctx = nullptr;
-std::thread device_thread;
+Reactor reactor;
+MacroScheduler macro_scheduler(reactor);
+ConfigWatcher config_watcher(reactor);
+std::thread reactor_thread;
+int device_scan_timer = -1;
+libusb_hotplug_callback_handle hotplug_handle;
+bool hotplug_registered = false;
 
 // --- Forward Declarations ---
 static void quit_driver(GtkMenuItem *item, gpointer user_data);
@@ -38,25 +50,61 @@ uint16_t get_device_key(libusb_device *dev) {
     return (libusb_get_bus_number(dev) << 8) | libusb_get_device_address(dev);
 }
 
+// Lowest index no connected device uses; it numbers the device's LCD pipe and
+// framebuffer, so a single G13 always gets the plain names.
+int next_device_index() {
+    int index = 0;
+    bool taken = true;
+    while (taken) {
+        taken = false;
+        for (const auto& instance : g13_instances) {
+            if (instance.second->deviceIndex() == index) {
+                taken = true;
+                index++;
+                break;
+            }
+        }
+    }
+    return index;
+}
+
 // --- G13 Device Handling ---
-void executeG13(libusb_device *dev) {
+void attach_device(libusb_device *dev) {
     uint16_t key = get_device_key(dev);
-    
-    // Create G13 instance on stack (RAII)
-    {
-        G13 g13(dev);
-        g13.start(); 
-    } // g13 destructor called here
-
-    // Cleanup after device disconnects
-    std::lock_guard<std::mutex> lock(g13_map_mutex);
-    if (g13_instances.find(key) != g13_instances.end()) {
-        // Thread is managed in the map
-    }
-    libusb_unref_device(dev);
+    if (g13_instances.find(key) != g13_instances.end()) return;
+
+    syslog(LOG_INFO, "New G13 device connected (ID: %x). Registering with reactor.", key);
+    auto g13 = std::make_unique<G13>(dev, next_device_index(), reactor, macro_scheduler);
+    if (!g13->start()) {
+        syslog(LOG_ERR, "Could not start G13 device (ID: %x).", key);
+        return;
+    }
+    g13_instances[key] = std::move(g13);
+}
+
+void reap_disconnected_devices() {
+    for (auto it = g13_instances.begin(); it != g13_instances.end();) {
+        if (it->second->isDisconnected()) {
+            syslog(LOG_INFO, "Removing G13 device (ID: %x).", it->first);
+            it = g13_instances.erase(it); // G13 destructor called here
+        } else {
+            ++it;
+        }
+    }
+}
+
+void detach_device(uint16_t key) {
+    auto it = g13_instances.find(key);
+    if (it == g13_instances.end()) return;
+
+    syslog(LOG_INFO, "G13 device removed (ID: %x).", key);
+    g13_instances.erase(it); // G13 destructor called here
 }
 
+// Fallback for platforms without hotplug support: rescan the bus periodically.
 void find_and_manage_devices() {
+    reap_disconnected_devices();
+
     libusb_device **devs;
     ssize_t count = libusb_get_device_list(ctx, &devs);
     if (count < 0) return;
@@ -66,26 +114,79 @@ void find_and_manage_devices() {
         if (libusb_get_device_descriptor(devs[i], &desc) < 0) continue;
 
         if (desc.idVendor == G13_VENDOR_ID && desc.idProduct == G13_PRODUCT_ID) {
-            uint16_t key = get_device_key(devs[i]);
-            
-            std::lock_guard<std::mutex> lock(g13_map_mutex);
-            if (g13_instances.find(key) == g13_instances.end()) {
-                syslog(LOG_INFO, "New G13 device connected (ID: %x). Starting handler thread.", key);
-                
-                libusb_ref_device(devs[i]);
-                // Move semantic for std::thread
-                g13_instances[key] = std::thread(executeG13, devs[i]);
-            }
+            attach_device(devs[i]);
         }
     }
     libusb_free_device_list(devs, 1);
 }
 
-void device_management_thread_loop() {
-    while (daemon_keep_running) {
+// Runs inside libusb event handling, where opening the device or doing
+// synchronous I/O is not allowed, so the actual work is posted to the reactor.
+static int LIBUSB_CALL hotplug_callback(libusb_context *context, libusb_device *dev,
+                                        libusb_hotplug_event event, void *user_data) {
+    uint16_t key = get_device_key(dev);
+
+    if (event == LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED) {
+        libusb_ref_device(dev);
+        reactor.post([dev]() {
+            attach_device(dev);
+            libusb_unref_device(dev);
+        });
+    } else if (event == LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT) {
+        reactor.post([key]() {
+            detach_device(key);
+            reap_disconnected_devices();
+        });
+    }
+    return 0; // Stay registered
+}
+
+bool register_hotplug() {
+    if (!libusb_has_capability(LIBUSB_CAP_HAS_HOTPLUG)) {
+        syslog(LOG_INFO, "libusb has no hotplug support on this platform.");
+        return false;
+    }
+
+    // ENUMERATE reports already connected devices through the same callback.
+    int error = libusb_hotplug_register_callback(ctx,
+        LIBUSB_HOTPLUG_EVENT_DEVICE_ARRIVED | LIBUSB_HOTPLUG_EVENT_DEVICE_LEFT,
+        LIBUSB_HOTPLUG_ENUMERATE, G13_VENDOR_ID, G13_PRODUCT_ID, LIBUSB_HOTPLUG_MATCH_ANY,
+        hotplug_callback, nullptr, &hotplug_handle);
+    if (error != LIBUSB_SUCCESS) {
+        syslog(LOG_ERR, "Could not register hotplug callback: %s", libusb_error_name(error));
+        return false;
+    }
+    return true;
+}
+
+void reactor_thread_loop() {
+    // Compile (or load the cached images of) every profile before the first
+    // device shows up, so switching profiles in game never touches the disk.
+    ProfileCache::preload();
+    config_watcher.start([](int profile) {
+        for (auto& entry : g13_instances) {
+            entry.second->reloadProfile(profile);
+        }
+    });
+
+    hotplug_registered = register_hotplug();
+    if (hotplug_registered) {
+        syslog(LOG_INFO, "Using hotplug events for G13 discovery.");
+    } else {
+        syslog(LOG_INFO, "Falling back to polling the USB bus for G13 devices.");
         find_and_manage_devices();
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+        device_scan_timer = reactor.add_timer(G13_DEVICE_SCAN_MS, find_and_manage_devices);
     }
+
+    reactor.run();
+
+    // Tear devices down on the thread that drove them.
+    if (hotplug_registered) {
+        libusb_hotplug_deregister_callback(ctx, hotplug_handle);
+    }
+    reactor.remove_timer(device_scan_timer);
+    config_watcher.stop();
+    g13_instances.clear();
 }
 
 // --- Tray Icon and Main Application Logic ---
@@ -150,21 +251,12 @@ static void quit_driver(GtkMenuItem *item, gpointer user_data) {
     syslog(LOG_INFO, "Shutting down driver...");
     daemon_keep_running = 0;
     
-    // Join the device management thread
-    if (device_thread.joinable()) {
-        device_thread.join();
+    // Stop the reactor; it releases all G13 devices before returning
+    reactor.stop();
+    if (reactor_thread.joinable()) {
+        reactor_thread.join();
     }
-    syslog(LOG_INFO, "Device management thread finished.");
-
-    // Join all active G13 handler threads
-    std::lock_guard<std::mutex> lock(g13_map_mutex);
-    for (auto& [key, th] : g13_instances) {
-        if (th.joinable()) {
-            th.join();
-        }
-    }
-    g13_instances.clear();
-    syslog(LOG_INFO, "All G13 handler threads have finished.");
+    syslog(LOG_INFO, "Reactor thread finished. All G13 devices released.");
 
     // Clean up global resources
     if(indicator) {
@@ -178,10 +270,42 @@ static void quit_driver(GtkMenuItem *item, gpointer user_data) {
     gtk_main_quit();
 }
 
+/**
+ * @brief Converts between the .properties files and a profile bundle.
+ * --pack-bundle [FILE] writes the config directory into a bundle,
+ * --unpack-bundle [FILE] writes a bundle back as .properties files.
+ * FILE defaults to the bundle the driver loads (see ConfigPath::getBundlePath).
+ * @return The process exit code.
+ */
+static int run_bundle_command(const std::string& command, const std::string& path) {
+    if (command == "--pack-bundle") {
+        int count = ProfileBundle::pack(path);
+        if (count < 0) {
+            std::cerr << "Could not write " << path << std::endl;
+            return 1;
+        }
+        std::cout << "Packed " << count << " files into " << path << std::endl;
+        return 0;
+    }
+
+    ProfileBundle bundle;
+    int count = bundle.open(path) ? bundle.unpack() : -1;
+    if (count < 0) {
+        std::cerr << "Could not unpack " << path << std::endl;
+        return 1;
+    }
+    std::cout << "Unpacked " << count << " files into " << ConfigPath::getConfigDir() << std::endl;
+    return 0;
+}
+
 extern "C" int main(int argc, char *argv[]) {
     // 0. Initialize Syslog
     openlog("linux-g13-driver", LOG_PID | LOG_CONS, LOG_USER);
 
+    if (argc > 1 && (std::string(argv[1]) == "--pack-bundle" || std::string(argv[1]) == "--unpack-bundle")) {
+        return run_bundle_command(argv[1], argc > 2 ? argv[2] : ConfigPath::getBundlePath());
+    }
+
     // 1. Initialize GTK
     gtk_init(&argc, &argv);
 
@@ -198,6 +322,12 @@ extern "C" int main(int argc, char *argv[]) {
         UInput::close_uinput();
         return 1;
     }
+    if (!reactor.init(ctx) || !macro_scheduler.init()) {
+        syslog(LOG_ERR, "Failed to initialize event reactor. Exiting.");
+        UInput::close_uinput();
+        libusb_exit(ctx);
+        return 1;
+    }
 
     // 4. Register signal handlers
     signal(SIGINT, signal_handler);
@@ -208,9 +338,9 @@ extern "C" int main(int argc, char *argv[]) {
     syslog(LOG_INFO, "G13 driver started. Tray icon is active.");
     
     try {
-        device_thread = std::thread(device_management_thread_loop);
+        reactor_thread = std::thread(reactor_thread_loop);
     } catch (const std::system_error& e) {
-        syslog(LOG_ERR, "Failed to create device management thread: %s", e.what());
+        syslog(LOG_ERR, "Failed to create reactor thread: %s", e.what());
         UInput::close_uinput();
         libusb_exit(ctx);
         return 1;
@@ -0,0 +1,49 @@
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "MappedFile.h"
+
+MappedFile::MappedFile() : address(nullptr), length(0) {
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0) {
+        ::close(fd);
+        return false;
+    }
+    if (file_stat.st_size > 0) {
+        void *mapping = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            ::close(fd);
+            return false;
+        }
+        address = mapping;
+        length = file_stat.st_size;
+    }
+    ::close(fd); // the mapping stays valid
+    return true;
+}
+
+void MappedFile::close() {
+    if (address) {
+        munmap(address, length);
+    }
+    address = nullptr;
+    length = 0;
+}
+
+std::string_view MappedFile::data() const {
+    return std::string_view(static_cast<const char*>(address), length);
+}
@@ -0,0 +1,41 @@
+#ifndef __MAPPED_FILE_H__
+#define __MAPPED_FILE_H__
+
+#include <stddef.h>
+#include <string>
+#include <string_view>
+
+/**
+ * @class MappedFile
+ * @brief A read-only memory mapping of a whole file.
+ *
+ * Only for files that are replaced by rename() rather than rewritten in place:
+ * a file truncated under a live mapping faults on access.
+ */
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Maps a file, replacing any previous mapping.
+     * @param path The file to map.
+     * @return true on success (an empty file maps to empty data), false on failure.
+     */
+    bool open(const std::string& path);
+
+    /** @brief Unmaps the file. */
+    void close();
+
+    /** @brief The mapped bytes; empty if nothing is mapped. */
+    std::string_view data() const;
+
+private:
+    void  *address;
+    size_t length;
+};
+
+#endif // __MAPPED_FILE_H__
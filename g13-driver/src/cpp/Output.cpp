@@ -9,7 +9,6 @@
 #include <linux/uinput.h>
 #include <fcntl.h>
 #include <mutex>
-#include <sys/time.h> // for gettimeofday
 #include <syslog.h> //  Logging
 
 #include "Output.h"
@@ -20,31 +19,97 @@ using namespace std;
 // Initialization of static class members.
 int UInput::file = -1;
 std::mutex UInput::plock;
+thread_local UInput::Batch *UInput::active_batch = nullptr;
 
 /**
  * @brief Sends a single input event to the virtual uinput device.
+ *
+ * The timestamp is left zeroed: uinput ignores it and the input core stamps
+ * events on delivery.
  */
 void UInput::send_event(int type, int code, int val) {
 	if (file < 0) {
 		return;
 	}
 
-    // Modern C++ RAII lock (replaces pthread_mutex_lock/unlock)
-	const std::lock_guard<std::mutex> lock(plock);
+	if (active_batch) {
+		active_batch->push(type, code, val);
+		return;
+	}
 
 	struct input_event event;
 	memset(&event, 0, sizeof(event));
-	gettimeofday(&event.time, nullptr); // Set the event timestamp.
 	event.type = type;
 	event.code = code;
 	event.value = val;
+	write_events(&event, 1);
+}
+
+/**
+ * @brief Writes a run of events to the uinput file descriptor in one call.
+ */
+void UInput::write_events(const struct input_event *events, int count) {
+    // Modern C++ RAII lock (replaces pthread_mutex_lock/unlock)
+	const std::lock_guard<std::mutex> lock(plock);
 
-	// Write the event structure to the uinput file descriptor.
-	if (write(file, &event, sizeof(event)) < 0) {
+	if (write(file, events, count * sizeof(struct input_event)) < 0) {
         // Optional: Error handling if write fails
     }
 }
 
+/**
+ * @brief Starts collecting events on this thread, unless a batch already is.
+ */
+UInput::Batch::Batch() : count(0), open_frame(false) {
+	owner = (active_batch == nullptr);
+	if (owner) {
+		active_batch = this;
+	}
+}
+
+/**
+ * @brief Writes whatever is still queued and stops collecting.
+ */
+UInput::Batch::~Batch() {
+	if (!owner) return;
+	flush();
+	active_batch = nullptr;
+}
+
+/**
+ * @brief Queues one event, merging SYN_REPORTs that would close an empty frame.
+ */
+void UInput::Batch::push(int type, int code, int val) {
+	if (type == EV_SYN && code == SYN_REPORT) {
+		if (!open_frame) return;
+		open_frame = false;
+	} else {
+		open_frame = true;
+	}
+
+	if (count == G13_UINPUT_BATCH_SIZE) {
+		flush();
+	}
+
+	struct input_event &event = events[count++];
+	memset(&event, 0, sizeof(event));
+	event.type = type;
+	event.code = code;
+	event.value = val;
+}
+
+/**
+ * @brief Writes all queued events with a single syscall.
+ */
+void UInput::Batch::flush() {
+	if (!owner || count == 0 || file < 0) {
+		count = 0;
+		return;
+	}
+	write_events(events, count);
+	count = 0;
+}
+
 /**
  * @brief Flushes any buffered data.
  */
@@ -2,6 +2,9 @@
 #define __OUTPUT_H__
 
 #include <mutex>
+#include <linux/input.h>
+
+#include "Constants.h"
 
 /**
  * @class UInput
@@ -12,18 +15,56 @@
  * All operations are thread-safe using std::mutex.
  */
 class UInput {
+public:
+    /**
+     * @class Batch
+     * @brief Collects events and writes them to uinput with a single write().
+     *
+     * While a Batch is alive, send_event() calls made on the same thread are
+     * queued in it instead of being written one at a time. A SYN_REPORT that
+     * would close an empty frame (e.g. right after another SYN_REPORT) is
+     * dropped. Queued events are written by flush() or by the destructor.
+     * Batches nest: an inner Batch forwards to the outermost one.
+     */
+    class Batch {
+    public:
+        Batch();
+        ~Batch();
+
+        Batch(const Batch&) = delete;
+        Batch& operator=(const Batch&) = delete;
+
+        /** @brief Writes all queued events. */
+        void flush();
+
+    private:
+        void push(int type, int code, int val);
+
+        struct input_event events[G13_UINPUT_BATCH_SIZE];
+        int  count;
+        bool open_frame;  // Events were queued since the last SYN_REPORT.
+        bool owner;       // False for a nested batch that forwards to the outer one.
+
+        friend class UInput;
+    };
+
 private:
     /** The file descriptor for the opened /dev/uinput device. */
     static int file;
     /** A mutex to ensure thread-safe access to the file descriptor. */
     static std::mutex plock;
+    /** The batch collecting events on the current thread, if any. */
+    static thread_local Batch *active_batch;
+
+    /** @brief Writes a run of events with one syscall. */
+    static void write_events(const struct input_event *events, int count);
 
 public:
     // Prevent instantiation of this static utility class.
     UInput() = delete;
 
     /**
-     * @brief Sends an input event to the kernel.
+     * @brief Sends an input event to the kernel, or queues it in the active Batch.
      * @param type The event type (e.g., EV_KEY).
      * @param code The event code (e.g., KEY_A).
      * @param val The event value (e.g., 1 for press, 0 for release).
@@ -33,14 +33,32 @@ void PassThroughAction::setKeyCode(int code) {
 	this->keycode = code;
 }
 
+/**
+ * @brief Updates the key's state and forwards a transition to uinput.
+ * @param state The new state (0 for released, non-zero for pressed).
+ * @return 1 if the state changed, 0 otherwise.
+ */
+int PassThroughAction::set(int state) {
+	if (!update(state)) {
+		return 0;
+	}
+
+	if (isPressed()) {
+		key_down();
+	}
+	else {
+		key_up();
+	}
+	return 1;
+}
+
 /**
  * @brief Handles the key-down event by sending a key press to uinput.
  */
 void PassThroughAction::key_down() {
 	// Send a key press event (value 1) for the stored keycode.
+	// The SYN_REPORT closing the frame is sent once per HID report by G13.
 	UInput::send_event(EV_KEY, this->keycode, 1);
-	// Send a synchronization event to report that the event is complete.
-	UInput::send_event(0, 0, 0); // SYN_REPORT
 }
 
 /**
@@ -49,6 +67,4 @@ void PassThroughAction::key_down() {
 void PassThroughAction::key_up() {
 	// Send a key release event (value 0) for the stored keycode.
 	UInput::send_event(EV_KEY, this->keycode, 0);
-	// Send a synchronization event.
-	UInput::send_event(0, 0, 0); // SYN_REPORT
 }
\ No newline at end of file
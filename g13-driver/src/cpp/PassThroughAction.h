@@ -15,11 +15,10 @@ private:
     /** The Linux keycode that this action will send. */
 	int keycode;
 
-protected:
-    /** @brief Overridden to send the key press event. */
-	void key_down() override;
-    /** @brief Overridden to send the key release event. */
-	void key_up() override;
+    /** @brief Sends the key press event. */
+	void key_down();
+    /** @brief Sends the key release event. */
+	void key_up();
 
 public:
     /**
@@ -28,8 +27,14 @@ public:
      */
 	PassThroughAction(int code);
 
-    /** @brief Virtual destructor. */
-	virtual ~PassThroughAction();
+    /** @brief Destructor. */
+	~PassThroughAction();
+
+    /**
+     * @brief Updates the key's state and sends the press/release on a change.
+     * @return 1 if the state changed, 0 otherwise.
+     */
+	int set(int state);
 
     /** @brief Gets the current keycode. */
 	int getKeyCode() const;
@@ -0,0 +1,144 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <syslog.h> // Logging
+#include <algorithm>
+#include <charconv>
+
+#include "ProcStats.h"
+
+/**
+ * @brief Reads the next whitespace separated number and advances past it.
+ */
+static bool next_number(std::string_view &rest, uint64_t *value) {
+    size_t start = rest.find_first_not_of(" \t");
+    if (start == std::string_view::npos) return false;
+    rest.remove_prefix(start);
+
+    auto result = std::from_chars(rest.data(), rest.data() + rest.size(), *value);
+    if (result.ec != std::errc()) return false;
+    rest.remove_prefix(result.ptr - rest.data());
+    return true;
+}
+
+/**
+ * @brief Cuts the next line off a text.
+ */
+static bool next_line(std::string_view &rest, std::string_view *line) {
+    if (rest.empty()) return false;
+    size_t newline = rest.find('\n');
+    *line = rest.substr(0, newline);
+    rest.remove_prefix(newline == std::string_view::npos ? rest.size() : newline + 1);
+    return true;
+}
+
+ProcStats::ProcStats()
+    : sources{
+        { "/proc/stat",    256,                  -1, 0 }, // the aggregate "cpu" line comes first
+        { "/proc/meminfo", 256,                  -1, 0 }, // MemTotal and MemAvailable are in the first lines
+        { "/proc/loadavg", 128,                  -1, 0 },
+        { "/proc/net/dev", sizeof(buffers[0]),   -1, 0 },
+    } {
+}
+
+ProcStats::~ProcStats() {
+    for (Source& source : sources) {
+        if (source.fd >= 0) ::close(source.fd);
+    }
+}
+
+void ProcStats::refresh(uint32_t mask) {
+    for (int i = 0; i < PROC_SOURCE_COUNT; i++) {
+        Source& source = sources[i];
+        if (!(mask & (1u << i))) continue;
+
+        if (source.fd < 0) {
+            source.fd = ::open(source.path, O_RDONLY | O_CLOEXEC);
+            if (source.fd < 0) {
+                syslog(LOG_ERR, "Cannot open %s: %s", source.path, strerror(errno));
+                continue;
+            }
+        }
+
+        ssize_t count = pread(source.fd, buffers[i], source.read_size, 0);
+        source.length = count > 0 ? count : 0;
+    }
+}
+
+std::string_view ProcStats::text(int index) const {
+    return std::string_view(buffers[index], sources[index].length);
+}
+
+bool ProcStats::cpuTimes(uint64_t *busy, uint64_t *total) const {
+    std::string_view line = text(0);
+    if (line.substr(0, 4) != "cpu ") return false;
+    line.remove_prefix(4);
+
+    // user nice system idle iowait irq softirq steal; guest time is already in user.
+    uint64_t value;
+    *busy = 0;
+    *total = 0;
+    for (int field = 0; field < 8 && next_number(line, &value); field++) {
+        *total += value;
+        if (field != 3 && field != 4) *busy += value;
+    }
+    return *total > 0;
+}
+
+bool ProcStats::memory(uint64_t *total_kb, uint64_t *available_kb) const {
+    std::string_view rest = text(1), line;
+    int found = 0;
+    while (found != 3 && next_line(rest, &line)) {
+        if (line.substr(0, 9) == "MemTotal:") {
+            line.remove_prefix(9);
+            if (next_number(line, total_kb)) found |= 1;
+        } else if (line.substr(0, 13) == "MemAvailable:") {
+            line.remove_prefix(13);
+            if (next_number(line, available_kb)) found |= 2;
+        }
+    }
+    return found == 3;
+}
+
+bool ProcStats::loadAverages(std::string_view *averages) const {
+    std::string_view line = text(2);
+    size_t end = 0;
+    for (int field = 0; field < 3; field++) {
+        end = line.find(' ', end + 1);
+        if (end == std::string_view::npos) return false;
+    }
+    *averages = line.substr(0, end);
+    return true;
+}
+
+bool ProcStats::netBytes(std::string_view interface, uint64_t *rx, uint64_t *tx) const {
+    std::string_view rest = text(3), line;
+    bool found = false;
+    *rx = 0;
+    *tx = 0;
+
+    // "  eth0: rx_bytes packets errs drop fifo frame compressed multicast tx_bytes ..."
+    while (next_line(rest, &line)) {
+        size_t colon = line.find(':');
+        if (colon == std::string_view::npos) continue; // the two header lines
+
+        std::string_view name = line.substr(0, colon);
+        name.remove_prefix(std::min(name.find_first_not_of(' '), name.size()));
+        if (interface.empty() ? name == "lo" : name != interface) continue;
+
+        std::string_view fields = line.substr(colon + 1);
+        uint64_t value, received = 0, sent = 0;
+        bool valid = next_number(fields, &received);
+        for (int field = 1; valid && field < 8; field++) {
+            valid = next_number(fields, &value);
+        }
+        if (!valid || !next_number(fields, &sent)) continue;
+
+        *rx += received;
+        *tx += sent;
+        found = true;
+        if (!interface.empty()) break;
+    }
+    return found;
+}
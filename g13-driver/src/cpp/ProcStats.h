@@ -0,0 +1,73 @@
+#ifndef __PROC_STATS_H__
+#define __PROC_STATS_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string_view>
+
+#define PROC_SOURCE_COUNT 4
+
+/**
+ * @enum proc_source_t
+ * @brief The /proc files ProcStats can sample, as bits of a mask.
+ */
+enum proc_source_t : uint32_t {
+    PROC_STAT    = 1 << 0, // /proc/stat
+    PROC_MEMINFO = 1 << 1, // /proc/meminfo
+    PROC_LOADAVG = 1 << 2, // /proc/loadavg
+    PROC_NETDEV  = 1 << 3, // /proc/net/dev
+};
+
+/**
+ * @class ProcStats
+ * @brief Samples system counters straight from /proc.
+ *
+ * Each file is opened once and re-read with pread() at offset 0, which makes
+ * procfs regenerate it; no descriptor is opened per sample. Only the prefix a
+ * getter needs is read (the first line of /proc/stat, the head of
+ * /proc/meminfo) and getters stop parsing as soon as they have their values.
+ */
+class ProcStats {
+public:
+    ProcStats();
+    ~ProcStats();
+
+    ProcStats(const ProcStats&) = delete;
+    ProcStats& operator=(const ProcStats&) = delete;
+
+    /**
+     * @brief Re-reads the given files; the getters then report this sample.
+     * @param sources A mask of proc_source_t bits.
+     */
+    void refresh(uint32_t sources);
+
+    /** @brief Aggregate CPU time in clock ticks: busy (not idle or iowait) and total. */
+    bool cpuTimes(uint64_t *busy, uint64_t *total) const;
+
+    /** @brief MemTotal and MemAvailable in kB. */
+    bool memory(uint64_t *total_kb, uint64_t *available_kb) const;
+
+    /** @brief The 1, 5 and 15 minute load averages as printed by the kernel. */
+    bool loadAverages(std::string_view *averages) const;
+
+    /**
+     * @brief Bytes received and transmitted.
+     * @param interface An interface name, or empty for all interfaces but lo.
+     */
+    bool netBytes(std::string_view interface, uint64_t *rx, uint64_t *tx) const;
+
+private:
+    struct Source {
+        const char *path;
+        size_t      read_size; // How much of the file the getters need
+        int         fd;
+        size_t      length;    // Bytes of the last sample
+    };
+
+    std::string_view text(int index) const;
+
+    Source sources[PROC_SOURCE_COUNT];
+    char   buffers[PROC_SOURCE_COUNT][8192];
+};
+
+#endif // __PROC_STATS_H__
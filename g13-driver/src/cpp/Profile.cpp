@@ -0,0 +1,61 @@
+#include <utility>
+
+#include "Profile.h"
+
+Profile::Profile(int id) : id(id), has_color(false), color{0, 0, 0}, bindings{} {
+}
+
+int Profile::getId() const {
+    return id;
+}
+
+bool Profile::hasColor() const {
+    return has_color;
+}
+
+const uint8_t *Profile::getColor() const {
+    return color;
+}
+
+void Profile::setColor(int red, int green, int blue) {
+    has_color = true;
+    color[0] = (uint8_t)red;
+    color[1] = (uint8_t)green;
+    color[2] = (uint8_t)blue;
+}
+
+const Binding& Profile::getBinding(int key) const {
+    return bindings[key];
+}
+
+void Profile::setBinding(int key, const Binding& binding) {
+    bindings[key] = binding;
+}
+
+std::shared_ptr<const MacroProgram> Profile::getMacro(int macroId) const {
+    auto it = macros.find(macroId);
+    return it != macros.end() ? it->second : nullptr;
+}
+
+bool Profile::usesMacro(int macroId) const {
+    for (const Binding& binding : bindings) {
+        if (binding.type == BINDING_MACRO && binding.code == macroId) return true;
+    }
+    return false;
+}
+
+void Profile::addMacro(int macroId, std::shared_ptr<const MacroProgram> program) {
+    macros[macroId] = std::move(program);
+}
+
+const std::map<int, std::shared_ptr<const MacroProgram>>& Profile::getMacros() const {
+    return macros;
+}
+
+const std::vector<LcdWidget>& Profile::getWidgets() const {
+    return widgets;
+}
+
+void Profile::addWidget(const LcdWidget& widget) {
+    widgets.push_back(widget);
+}
@@ -0,0 +1,115 @@
+#ifndef __PROFILE_H__
+#define __PROFILE_H__
+
+#include <stdint.h>
+#include <array>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "Constants.h"
+#include "MacroProgram.h"
+
+/**
+ * @enum binding_type_t
+ * @brief What a key of a compiled profile is bound to.
+ */
+enum binding_type_t : uint8_t {
+    BINDING_NONE = 0,    // Unbound key (no-op).
+    BINDING_PASSTHROUGH, // Sends keycode `code`.
+    BINDING_MACRO        // Runs macro `code` with `repeats`.
+};
+
+/**
+ * @struct Binding
+ * @brief One key of a compiled profile.
+ */
+struct Binding {
+    int32_t type;    // A binding_type_t; 32 bits so the struct has no padding.
+    int32_t code;    // Keycode or macro ID.
+    int32_t repeats; // Macro repeat mode (see MacroAction).
+};
+
+static_assert(sizeof(Binding) == 12, "bindings are stored raw in profile images");
+
+/**
+ * @enum lcd_widget_t
+ * @brief A status line the driver draws on the LCD by itself (see LcdWidgets).
+ */
+enum lcd_widget_t : uint8_t {
+    WIDGET_CLOCK = 0, // Local time.
+    WIDGET_CPU,       // CPU usage with a bar.
+    WIDGET_MEMORY,    // Used and total memory.
+    WIDGET_LOAD,      // Load averages.
+    WIDGET_NET,       // Receive/transmit rates of `arg`, or of all interfaces but lo.
+    WIDGET_COUNT
+};
+
+/**
+ * @struct LcdWidget
+ * @brief One line of the profile's LCD status screen.
+ */
+struct LcdWidget {
+    uint8_t type;                      // A lcd_widget_t.
+    char    arg[G13_WIDGET_ARG_SIZE];  // NUL-terminated argument, e.g. a network interface.
+};
+
+static_assert(sizeof(LcdWidget) == 1 + G13_WIDGET_ARG_SIZE, "widgets are stored raw in profile images");
+
+/**
+ * @class Profile
+ * @brief A bindings-N.properties file compiled together with the macros it uses.
+ *
+ * Profiles are immutable once built by the ProfileCache, so devices can share
+ * them and keep them alive with a shared_ptr while their actions are bound.
+ */
+class Profile {
+public:
+    explicit Profile(int id);
+
+    /** @brief Gets the profile number (the N of bindings-N.properties). */
+    int getId() const;
+
+    /** @brief True if the profile sets a backlight color. */
+    bool hasColor() const;
+
+    /** @brief Gets the backlight color as {red, green, blue}. */
+    const uint8_t *getColor() const;
+
+    /** @brief Sets the backlight color. */
+    void setColor(int red, int green, int blue);
+
+    /** @brief Gets the binding of a key (0 .. G13_NUM_KEYS-1). */
+    const Binding& getBinding(int key) const;
+
+    /** @brief Sets the binding of a key (0 .. G13_NUM_KEYS-1). */
+    void setBinding(int key, const Binding& binding);
+
+    /** @brief Gets a compiled macro used by this profile, or nullptr if its file is missing. */
+    std::shared_ptr<const MacroProgram> getMacro(int macroId) const;
+
+    /** @brief True if a key is bound to the macro, even if its file is missing. */
+    bool usesMacro(int macroId) const;
+
+    /** @brief Adds a compiled macro used by this profile. */
+    void addMacro(int macroId, std::shared_ptr<const MacroProgram> program);
+
+    /** @brief Gets all macros used by this profile, by ID. */
+    const std::map<int, std::shared_ptr<const MacroProgram>>& getMacros() const;
+
+    /** @brief Gets the LCD status lines, top to bottom; empty if the profile has none. */
+    const std::vector<LcdWidget>& getWidgets() const;
+
+    /** @brief Appends an LCD status line. */
+    void addWidget(const LcdWidget& widget);
+
+private:
+    int id;
+    bool has_color;
+    uint8_t color[3];
+    std::array<Binding, G13_NUM_KEYS> bindings;
+    std::map<int, std::shared_ptr<const MacroProgram>> macros;
+    std::vector<LcdWidget> widgets;
+};
+
+#endif // __PROFILE_H__
@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <fstream>
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+#include <syslog.h> // Logging
+
+#include "ProfileBundle.h"
+#include "Properties.h"
+#include "ConfigPath.h"
+#include "Constants.h"
+
+#define BUNDLE_MAGIC   0x42333147 // "G13B"
+#define BUNDLE_VERSION 1
+
+/**
+ * @struct BundleHeader
+ * @brief Start of a bundle, followed by entry_count index entries.
+ */
+struct BundleHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entry_count;
+    uint32_t reserved;
+};
+
+/** One index entry; offset and length locate the text within the file. */
+struct ProfileBundle::Entry {
+    uint8_t  kind;        // A config_file_t.
+    uint8_t  reserved[3];
+    int32_t  id;
+    uint32_t offset;
+    uint32_t length;
+};
+
+static bool entry_less(uint8_t kind_a, int32_t id_a, uint8_t kind_b, int32_t id_b) {
+    return kind_a != kind_b ? kind_a < kind_b : id_a < id_b;
+}
+
+ProfileBundle::ProfileBundle() : entries(nullptr), entry_count(0) {
+}
+
+bool ProfileBundle::open(const std::string& path) {
+    close();
+    if (!file.open(path)) return false;
+
+    std::string_view data = file.data();
+    BundleHeader header;
+    if (data.size() < sizeof(header)) {
+        syslog(LOG_ERR, "Profile bundle %s is truncated.", path.c_str());
+        close();
+        return false;
+    }
+    memcpy(&header, data.data(), sizeof(header));
+    if (header.magic != BUNDLE_MAGIC || header.version != BUNDLE_VERSION ||
+        (data.size() - sizeof(header)) / sizeof(Entry) < header.entry_count) {
+        syslog(LOG_ERR, "Profile bundle %s is not a valid bundle.", path.c_str());
+        close();
+        return false;
+    }
+
+    // The mapping is page aligned and the header keeps the index aligned.
+    const Entry *index = reinterpret_cast<const Entry*>(data.data() + sizeof(header));
+    for (uint32_t i = 0; i < header.entry_count; i++) {
+        bool in_bounds = index[i].kind <= CONFIG_FILE_MACRO && (uint64_t)index[i].offset + index[i].length <= data.size();
+        bool sorted = i == 0 || entry_less(index[i - 1].kind, index[i - 1].id, index[i].kind, index[i].id);
+        if (!in_bounds || !sorted) {
+            syslog(LOG_ERR, "Profile bundle %s has a corrupt index.", path.c_str());
+            close();
+            return false;
+        }
+    }
+
+    entries = index;
+    entry_count = header.entry_count;
+    syslog(LOG_INFO, "Using profile bundle %s (%u files).", path.c_str(), entry_count);
+    return true;
+}
+
+void ProfileBundle::close() {
+    file.close();
+    entries = nullptr;
+    entry_count = 0;
+}
+
+bool ProfileBundle::isOpen() const {
+    return entries != nullptr;
+}
+
+bool ProfileBundle::find(config_file_t kind, int id, std::string_view *text) const {
+    const Entry *end = entries + entry_count;
+    const Entry *entry = std::lower_bound(entries, end, 0, [kind, id](const Entry& candidate, int) {
+        return entry_less(candidate.kind, candidate.id, kind, id);
+    });
+    if (entry == end || entry->kind != kind || entry->id != id) return false;
+
+    *text = file.data().substr(entry->offset, entry->length);
+    return true;
+}
+
+int ProfileBundle::pack(const std::string& path) {
+    std::vector<Entry> index;
+    std::string texts, buffer;
+
+    auto add = [&](config_file_t kind, int id, const std::string& filename) {
+        if (!PropertiesReader::readFile(filename, &buffer)) return;
+        Entry entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.kind = kind;
+        entry.id = id;
+        entry.offset = texts.size(); // relative to the texts until the index size is known
+        entry.length = buffer.size();
+        index.push_back(entry);
+        texts += buffer;
+    };
+    for (int id = 0; id < G13_NUM_PROFILES; id++) {
+        add(CONFIG_FILE_BINDINGS, id, ConfigPath::getBindingPath(id));
+    }
+    for (int id = 0; id < G13_MAX_MACROS; id++) {
+        add(CONFIG_FILE_MACRO, id, ConfigPath::getMacroPath(id));
+    }
+
+    BundleHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = BUNDLE_MAGIC;
+    header.version = BUNDLE_VERSION;
+    header.entry_count = index.size();
+    uint32_t texts_offset = sizeof(header) + index.size() * sizeof(Entry);
+    for (Entry& entry : index) {
+        entry.offset += texts_offset;
+    }
+
+    std::string temp = path + ".tmp";
+    std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(Entry));
+    out.write(texts.data(), texts.size());
+    out.close();
+    if (!out || rename(temp.c_str(), path.c_str()) != 0) {
+        remove(temp.c_str());
+        return -1;
+    }
+    return index.size();
+}
+
+int ProfileBundle::unpack() const {
+    if (!isOpen()) return -1;
+
+    for (uint32_t i = 0; i < entry_count; i++) {
+        const Entry& entry = entries[i];
+        std::string filename = entry.kind == CONFIG_FILE_BINDINGS ? ConfigPath::getBindingPath(entry.id)
+                                                             : ConfigPath::getMacroPath(entry.id);
+        std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+        out.write(file.data().data() + entry.offset, entry.length);
+        if (!out) {
+            syslog(LOG_ERR, "Could not write %s", filename.c_str());
+            return -1;
+        }
+    }
+    return entry_count;
+}
@@ -0,0 +1,73 @@
+#ifndef __PROFILE_BUNDLE_H__
+#define __PROFILE_BUNDLE_H__
+
+#include <stdint.h>
+#include <string>
+#include <string_view>
+
+#include "MappedFile.h"
+
+/**
+ * @enum config_file_t
+ * @brief The kinds of properties files a configuration is made of.
+ */
+enum config_file_t : uint8_t {
+    CONFIG_FILE_BINDINGS = 0, // bindings-N.properties
+    CONFIG_FILE_MACRO         // macro-N.properties
+};
+
+/**
+ * @class ProfileBundle
+ * @brief All bindings and macro files of a configuration packed into one file.
+ *
+ * The bundle is a header, an index sorted by (kind, id) and the properties
+ * texts themselves, unchanged. It is memory mapped and looked up in place,
+ * so loading every profile costs one mmap instead of hundreds of small reads.
+ *
+ * pack() and unpack() convert to and from the directory of .properties files.
+ */
+class ProfileBundle {
+public:
+    ProfileBundle();
+
+    /**
+     * @brief Maps a bundle and validates its index.
+     * @return false if the file is missing or not a valid bundle.
+     */
+    bool open(const std::string& path);
+
+    /** @brief Unmaps the bundle. */
+    void close();
+
+    /** @brief True if a bundle is mapped. */
+    bool isOpen() const;
+
+    /**
+     * @brief Looks up the text of one properties file.
+     * @param text Receives a view into the mapping, valid until close().
+     * @return false if the bundle has no such entry.
+     */
+    bool find(config_file_t kind, int id, std::string_view *text) const;
+
+    /**
+     * @brief Packs the properties files of the config directory into a bundle.
+     * @param path The bundle to write; replaced atomically.
+     * @return The number of packed files, or -1 on failure.
+     */
+    static int pack(const std::string& path);
+
+    /**
+     * @brief Writes every entry of the bundle back as a properties file.
+     * @return The number of written files, or -1 on failure.
+     */
+    int unpack() const;
+
+private:
+    struct Entry;
+
+    MappedFile file;
+    const Entry *entries;
+    uint32_t entry_count;
+};
+
+#endif // __PROFILE_BUNDLE_H__
@@ -0,0 +1,457 @@
+#include <fstream>
+#include <iterator>
+#include <sys/stat.h>
+#include <stdio.h>
+#include <string.h>
+#include <syslog.h> // Logging
+
+#include "ProfileCache.h"
+#include "Properties.h"
+#include "ConfigPath.h"
+#include "MacroStore.h"
+#include "ProfileBundle.h"
+
+#define PROFILE_IMAGE_MAGIC   0x50333147 // "G13P"
+#define PROFILE_IMAGE_VERSION 3
+
+/**
+ * @struct ImageHeader
+ * @brief Start of a profile image, followed by the sources, the bindings, the
+ * LCD widgets and the macros ({id, op count, ops}).
+ */
+struct ImageHeader {
+    uint32_t magic;
+    uint32_t version;
+    int32_t  profile_id;
+    uint32_t source_count;
+    uint32_t macro_count;
+    uint32_t widget_count;
+    uint8_t  has_color;
+    uint8_t  color[3];
+};
+
+static_assert(sizeof(ImageHeader) == 28, "the header is stored raw, so it must have no padding");
+
+std::shared_ptr<const Profile> ProfileCache::profiles[G13_NUM_PROFILES];
+
+static const char *default_bindings = R"RAW(
+# Default G13 Key Bindings
+G19=p,k.42
+G18=p,k.18
+G17=p,k.16
+G16=p,k.10
+G9=p,k.3
+G15=p,k.9
+G8=p,k.2
+G14=p,k.8
+G7=p,k.15
+G13=p,k.7
+G12=p,k.6
+G6=p,k.46
+G11=p,k.5
+G5=p,k.76
+G10=p,k.4
+G4=p,k.75
+G3=p,k.81
+G2=p,k.80
+G1=p,k.79
+G0=p,k.1
+G39=p,k.31
+color=0,0,255
+G38=p,k.32
+G37=p,k.30
+G36=p,k.17
+G35=p,k.11
+G34=p,k.72
+G33=p,k.71
+G32=p,k.62
+G31=p,k.61
+G30=p,k.60
+G29=p,k.59
+G23=p,k.58
+G22=p,k.57
+G21=p,k.57
+G20=p,k.50
+)RAW";
+
+// Config files are parsed from here; reused so steady-state loads don't allocate.
+static std::string file_buffer;
+
+// When the config directory holds a profile bundle, every bindings and macro
+// file comes from it and the .properties files are ignored.
+static ProfileBundle bundle;
+static bool bundle_checked = false;
+
+/**
+ * @brief Gets the text of a config file, from the bundle if one is in use.
+ * @param text Receives the text; valid until the next call.
+ */
+static bool read_config(config_file_t kind, int id, const std::string& filename, std::string_view *text) {
+    if (bundle.isOpen()) return bundle.find(kind, id, text);
+    if (!PropertiesReader::readFile(filename, &file_buffer)) return false;
+    *text = file_buffer;
+    return true;
+}
+
+/**
+ * @brief Reads and compiles macro-N.properties.
+ * @return The compiled program, or nullptr if the file cannot be read.
+ */
+static std::shared_ptr<const MacroProgram> load_macro(int num) {
+    std::string filename = ConfigPath::getMacroPath(num);
+    std::string_view text, sequence;
+    if (!read_config(CONFIG_FILE_MACRO, num, filename, &text)) return nullptr;
+
+    PropertiesReader reader(text, filename.c_str());
+    while (reader.next()) {
+        if (reader.key() == "sequence") sequence = reader.value();
+    }
+    return MacroStore::insert(num, MacroProgram::compile(sequence));
+}
+
+/**
+ * @brief Parses one "G<key>=p,k.<code>" or "G<key>=m,<macro>,<repeats>" entry.
+ * @return false (after logging the line) if the entry is malformed.
+ */
+static bool parse_binding(const PropertiesReader& reader, Profile& profile, std::vector<int>& macro_ids) {
+    int gKey;
+    if (!PropertiesReader::parseNumber(reader.key().substr(1), &gKey) || gKey < 0 || gKey >= G13_NUM_KEYS) {
+        reader.error("invalid key", reader.key());
+        return false;
+    }
+
+    std::string_view rest = reader.value(), type, field;
+    if (!PropertiesReader::nextField(rest, &type)) {
+        reader.error("missing binding type for", reader.key());
+        return false;
+    }
+
+    if (type == "p") {
+        int keycode;
+        if (!PropertiesReader::nextField(rest, &field) || field.substr(0, 2) != "k." ||
+            !PropertiesReader::parseNumber(field.substr(2), &keycode)) {
+            reader.error("invalid key binding", reader.value());
+            return false;
+        }
+        profile.setBinding(gKey, Binding{ BINDING_PASSTHROUGH, keycode, 0 });
+    }
+    else if (type == "m") {
+        int macroId, repeats;
+        if (!PropertiesReader::nextField(rest, &field) || !PropertiesReader::parseNumber(field, &macroId) ||
+            macroId < 0 || macroId >= G13_MAX_MACROS ||
+            !PropertiesReader::nextField(rest, &field) || !PropertiesReader::parseNumber(field, &repeats)) {
+            reader.error("invalid macro binding", reader.value());
+            return false;
+        }
+        profile.setBinding(gKey, Binding{ BINDING_MACRO, macroId, repeats });
+        macro_ids.push_back(macroId);
+    }
+    else {
+        reader.error("unknown binding type", type);
+        return false;
+    }
+    return true;
+}
+
+// Names used by the lcd= key, indexed by lcd_widget_t.
+static const char *widget_names[WIDGET_COUNT] = { "clock", "cpu", "memory", "load", "net" };
+
+/**
+ * @brief Parses lcd=widget[.arg],... into the profile's LCD status lines.
+ *
+ * The argument follows a '.', like the k.20 of a key binding: the config tool
+ * saves the file with Properties.store, which would escape a ':' to "\:".
+ * Only the first '.' splits, so "net.eth0.100" names a VLAN interface.
+ */
+static void parse_widgets(const PropertiesReader& reader, Profile& profile) {
+    std::string_view rest = reader.value(), field;
+    while (PropertiesReader::nextField(rest, &field)) {
+        if (profile.getWidgets().size() == G13_LCD_MAX_WIDGETS) {
+            reader.error("too many widgets, ignoring", field);
+            return;
+        }
+
+        size_t dot = field.find('.');
+        std::string_view name = field.substr(0, dot);
+        std::string_view arg = dot == std::string_view::npos ? std::string_view() : field.substr(dot + 1);
+
+        LcdWidget widget {};
+        widget.type = WIDGET_COUNT;
+        for (int type = 0; type < WIDGET_COUNT; type++) {
+            if (name == widget_names[type]) widget.type = type;
+        }
+        if (widget.type == WIDGET_COUNT || arg.size() >= sizeof(widget.arg)) {
+            reader.error("invalid widget", field);
+            continue;
+        }
+        memcpy(widget.arg, arg.data(), arg.size());
+        profile.addWidget(widget);
+    }
+}
+
+/**
+ * @brief Parses bindings into a profile and records the macros they reference.
+ */
+static void parse_bindings(std::string_view text, const char *source, Profile& profile, std::vector<int>& macro_ids) {
+    PropertiesReader reader(text, source);
+    while (reader.next()) {
+        std::string_view key = reader.key();
+
+        if (key == "color") {
+            std::string_view rest = reader.value(), field;
+            int rgb[3];
+            bool valid = true;
+            for (int i = 0; i < 3 && valid; i++) {
+                valid = PropertiesReader::nextField(rest, &field) && PropertiesReader::parseNumber(field, &rgb[i]) &&
+                        rgb[i] >= 0 && rgb[i] <= 255;
+            }
+            if (valid) profile.setColor(rgb[0], rgb[1], rgb[2]);
+            else reader.error("invalid color", reader.value());
+        }
+        else if (key == "lcd") {
+            parse_widgets(reader, profile);
+        }
+        else if (key.size() > 1 && key[0] == 'G') {
+            parse_binding(reader, profile, macro_ids);
+        }
+    }
+}
+
+std::shared_ptr<const Profile> ProfileCache::get(int id) {
+    if (id < 0 || id >= G13_NUM_PROFILES) return nullptr;
+    if (profiles[id]) return profiles[id];
+
+    if (!bundle_checked) {
+        bundle.open(ConfigPath::getBundlePath()); // fails quietly without a bundle
+        bundle_checked = true;
+    }
+
+    std::shared_ptr<Profile> profile = load_image(id);
+    if (!profile) {
+        std::vector<Source> sources;
+        profile = compile(id, sources);
+        save_image(*profile, sources);
+    }
+    profiles[id] = profile;
+    return profiles[id];
+}
+
+void ProfileCache::preload() {
+    for (int id = 0; id < G13_NUM_PROFILES; id++) {
+        get(id);
+    }
+}
+
+void ProfileCache::invalidate(int id) {
+    if (id >= 0 && id < G13_NUM_PROFILES) {
+        profiles[id].reset();
+    }
+}
+
+uint32_t ProfileCache::invalidateMacro(int macroId) {
+    uint32_t dropped = 0;
+    for (int id = 0; id < G13_NUM_PROFILES; id++) {
+        if (profiles[id] && profiles[id]->usesMacro(macroId)) {
+            profiles[id].reset();
+            dropped |= 1u << id;
+        }
+    }
+    return dropped;
+}
+
+void ProfileCache::invalidateAll() {
+    for (int id = 0; id < G13_NUM_PROFILES; id++) {
+        profiles[id].reset();
+    }
+    bundle.close();
+    bundle_checked = false;
+}
+
+ProfileCache::Source ProfileCache::stamp(uint8_t kind, int id) {
+    // With a bundle, every source is stamped with the bundle file itself.
+    std::string filename = bundle.isOpen() ? ConfigPath::getBundlePath() :
+                           kind == CONFIG_FILE_BINDINGS ? ConfigPath::getBindingPath(id) : ConfigPath::getMacroPath(id);
+    Source source;
+    memset(&source, 0, sizeof(source)); // images are compared and written byte-wise
+    source.kind = kind;
+    source.id = id;
+    source.size = -1;
+
+    struct stat file_stat;
+    if (stat(filename.c_str(), &file_stat) == 0) {
+        source.mtime_ns = (int64_t)file_stat.st_mtim.tv_sec * 1000000000LL + file_stat.st_mtim.tv_nsec;
+        source.size = file_stat.st_size;
+    }
+    return source;
+}
+
+/**
+ * @brief Builds a profile from the properties files, creating defaults if needed.
+ * @param sources Receives the files the profile was built from.
+ */
+std::shared_ptr<Profile> ProfileCache::compile(int id, std::vector<Source>& sources) {
+    auto profile = std::make_shared<Profile>(id);
+    std::vector<int> macro_ids;
+    std::string filename = ConfigPath::getBindingPath(id);
+
+    // Stamped before reading, so an edit racing with us makes the image stale.
+    sources.push_back(stamp(CONFIG_FILE_BINDINGS, id));
+
+    std::string_view text;
+    if (read_config(CONFIG_FILE_BINDINGS, id, filename, &text)) {
+        syslog(LOG_INFO, "Compiling config file: %s", filename.c_str());
+        parse_bindings(text, filename.c_str(), *profile, macro_ids);
+    }
+    else if (bundle.isOpen()) {
+        syslog(LOG_WARNING, "Profile bundle has no bindings-%d. Using defaults.", id);
+        parse_bindings(default_bindings, "default bindings", *profile, macro_ids);
+    }
+    else {
+        syslog(LOG_WARNING, "Config file not found: %s. Creating defaults.", filename.c_str());
+
+        // --- Create Default File ---
+        // If the file doesn't exist, we write the default settings to it
+        // so the user has something to edit in ~/.config/g13/
+        std::ofstream outfile(filename);
+        if (outfile.is_open()) {
+            outfile << default_bindings;
+            outfile.close();
+        } else {
+            syslog(LOG_ERR, "Could not create config file: %s", filename.c_str());
+        }
+        sources.back() = stamp(CONFIG_FILE_BINDINGS, id);
+
+        parse_bindings(default_bindings, "default bindings", *profile, macro_ids);
+    }
+
+    // Each macro is read and compiled once, however many keys, profiles and
+    // devices use it; the MacroStore hands out the shared program.
+    for (int macroId : macro_ids) {
+        if (profile->getMacro(macroId)) continue;
+
+        sources.push_back(stamp(CONFIG_FILE_MACRO, macroId)); // before reading, as above
+        auto program = MacroStore::find(macroId);
+        if (!program) program = load_macro(macroId);
+        if (program) profile->addMacro(macroId, program);
+    }
+
+    return profile;
+}
+
+/**
+ * @brief Loads the binary image of a profile if none of its sources changed.
+ * @return The profile, or nullptr if there is no usable image.
+ */
+std::shared_ptr<Profile> ProfileCache::load_image(int id) {
+    std::string filename = ConfigPath::getProfileCachePath(id);
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) return nullptr;
+
+    std::vector<char> image((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    size_t offset = 0;
+    auto take = [&image, &offset](void *out, size_t length) {
+        if (image.size() - offset < length) return false;
+        memcpy(out, image.data() + offset, length);
+        offset += length;
+        return true;
+    };
+
+    ImageHeader header;
+    if (!take(&header, sizeof(header)) || header.magic != PROFILE_IMAGE_MAGIC ||
+        header.version != PROFILE_IMAGE_VERSION || header.profile_id != id) {
+        return nullptr;
+    }
+
+    for (uint32_t i = 0; i < header.source_count; i++) {
+        Source cached, current;
+        if (!take(&cached, sizeof(cached))) return nullptr;
+        current = stamp(cached.kind, cached.id);
+        if (memcmp(&cached, &current, sizeof(cached)) != 0) {
+            syslog(LOG_INFO, "Profile %d: cached image is stale, recompiling.", id);
+            return nullptr;
+        }
+    }
+
+    auto profile = std::make_shared<Profile>(id);
+    if (header.has_color) {
+        profile->setColor(header.color[0], header.color[1], header.color[2]);
+    }
+    for (int key = 0; key < G13_NUM_KEYS; key++) {
+        Binding binding;
+        if (!take(&binding, sizeof(binding))) return nullptr;
+        profile->setBinding(key, binding);
+    }
+    for (uint32_t i = 0; i < header.widget_count; i++) {
+        LcdWidget widget;
+        if (!take(&widget, sizeof(widget)) || widget.type >= WIDGET_COUNT) return nullptr;
+        widget.arg[sizeof(widget.arg) - 1] = '\0';
+        profile->addWidget(widget);
+    }
+    for (uint32_t i = 0; i < header.macro_count; i++) {
+        int32_t macroId;
+        uint32_t count;
+        if (!take(&macroId, sizeof(macroId)) || !take(&count, sizeof(count)) ||
+            (image.size() - offset) / sizeof(MacroOp) < count) {
+            return nullptr;
+        }
+        auto program = MacroStore::find(macroId);
+        if (!program) {
+            const MacroOp *ops = reinterpret_cast<const MacroOp*>(image.data() + offset);
+            program = MacroStore::insert(macroId, MacroProgram::fromOps(ops, count));
+        }
+        profile->addMacro(macroId, program);
+        offset += count * sizeof(MacroOp);
+    }
+
+    syslog(LOG_INFO, "Profile %d: loaded compiled image %s", id, filename.c_str());
+    return profile;
+}
+
+void ProfileCache::save_image(const Profile& profile, const std::vector<Source>& sources) {
+    std::string image;
+    auto put = [&image](const void *data, size_t length) {
+        image.append(static_cast<const char*>(data), length);
+    };
+
+    ImageHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = PROFILE_IMAGE_MAGIC;
+    header.version = PROFILE_IMAGE_VERSION;
+    header.profile_id = profile.getId();
+    header.source_count = sources.size();
+    header.macro_count = profile.getMacros().size();
+    header.widget_count = profile.getWidgets().size();
+    header.has_color = profile.hasColor();
+    memcpy(header.color, profile.getColor(), sizeof(header.color));
+    put(&header, sizeof(header));
+
+    for (const Source& source : sources) {
+        put(&source, sizeof(source));
+    }
+    for (int key = 0; key < G13_NUM_KEYS; key++) {
+        put(&profile.getBinding(key), sizeof(Binding));
+    }
+    for (const LcdWidget& widget : profile.getWidgets()) {
+        put(&widget, sizeof(widget));
+    }
+    for (const auto& entry : profile.getMacros()) {
+        int32_t macroId = entry.first;
+        uint32_t count = entry.second->size();
+        put(&macroId, sizeof(macroId));
+        put(&count, sizeof(count));
+        put(entry.second->data(), count * sizeof(MacroOp));
+    }
+
+    // Write to a temporary file first so a crash never leaves a torn image behind.
+    std::string filename = ConfigPath::getProfileCachePath(profile.getId());
+    std::string temp = filename + ".tmp";
+    std::ofstream file(temp, std::ios::binary | std::ios::trunc);
+    if (!file.is_open() || !file.write(image.data(), image.size())) {
+        syslog(LOG_WARNING, "Could not write profile cache: %s", temp.c_str());
+        return;
+    }
+    file.close();
+    if (rename(temp.c_str(), filename.c_str()) != 0) {
+        syslog(LOG_WARNING, "Could not write profile cache: %s", filename.c_str());
+    }
+}
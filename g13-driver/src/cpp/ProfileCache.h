@@ -0,0 +1,65 @@
+#ifndef __PROFILE_CACHE_H__
+#define __PROFILE_CACHE_H__
+
+#include <stdint.h>
+#include <memory>
+#include <vector>
+
+#include "Constants.h"
+#include "Profile.h"
+
+/**
+ * @class ProfileCache
+ * @brief Compiles bindings profiles once and keeps them in memory and on disk.
+ *
+ * A profile is compiled from bindings-N.properties and every macro-M.properties
+ * it references. The result is held in memory, so switching profiles is a
+ * pointer lookup, and written as a binary image to the cache directory. The
+ * image records the mtime and size of each source file; at startup it is used
+ * instead of the properties files as long as none of them changed.
+ *
+ * If the config directory holds a ProfileBundle, all files are taken from it.
+ *
+ * Reactor thread only.
+ */
+class ProfileCache {
+public:
+    /**
+     * @brief Gets a compiled profile. Only touches the disk the first time.
+     * @param id The profile number (0 .. G13_NUM_PROFILES-1).
+     */
+    static std::shared_ptr<const Profile> get(int id);
+
+    /** @brief Compiles all profiles ahead of time. */
+    static void preload();
+
+    /** @brief Drops a profile from memory so the next get() rebuilds it. */
+    static void invalidate(int id);
+
+    /**
+     * @brief Drops every profile that uses a macro.
+     * @return A bit mask of the dropped profile numbers.
+     */
+    static uint32_t invalidateMacro(int macroId);
+
+    /** @brief Drops every profile and re-checks for a profile bundle on the next get(). */
+    static void invalidateAll();
+
+private:
+    /** A source file of a profile, as it was when the profile was compiled. */
+    struct Source {
+        uint8_t kind;     // A config_file_t
+        int32_t id;
+        int64_t mtime_ns;
+        int64_t size;     // -1 if the file did not exist
+    };
+
+    static Source stamp(uint8_t kind, int id);
+    static std::shared_ptr<Profile> compile(int id, std::vector<Source>& sources);
+    static std::shared_ptr<Profile> load_image(int id);
+    static void save_image(const Profile& profile, const std::vector<Source>& sources);
+
+    static std::shared_ptr<const Profile> profiles[G13_NUM_PROFILES];
+};
+
+#endif // __PROFILE_CACHE_H__
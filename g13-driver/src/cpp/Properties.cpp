@@ -0,0 +1,88 @@
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <syslog.h> // Logging
+
+#include "Properties.h"
+
+PropertiesReader::PropertiesReader(std::string_view text, const char *source)
+    : cursor(text.data()), end(text.data() + text.size()), source(source), line_number(0) {
+}
+
+bool PropertiesReader::next() {
+    while (cursor < end) {
+        const char *eol = static_cast<const char*>(memchr(cursor, '\n', end - cursor));
+        if (!eol) eol = end;
+        line_number++;
+
+        std::string_view line = trim(std::string_view(cursor, eol - cursor));
+        cursor = eol < end ? eol + 1 : end;
+        if (line.empty() || line[0] == '#' || line[0] == '!') continue;
+
+        size_t eq_pos = line.find('=');
+        if (eq_pos == std::string_view::npos) {
+            error("missing '=' in", line);
+            continue;
+        }
+        current_key = trim(line.substr(0, eq_pos));
+        current_value = trim(line.substr(eq_pos + 1));
+        return true;
+    }
+    return false;
+}
+
+std::string_view PropertiesReader::key() const {
+    return current_key;
+}
+
+std::string_view PropertiesReader::value() const {
+    return current_value;
+}
+
+int PropertiesReader::line() const {
+    return line_number;
+}
+
+void PropertiesReader::error(const char *what, std::string_view token) const {
+    syslog(LOG_WARNING, "%s:%d: %s '%.*s'", source, line_number, what, (int)token.size(), token.data());
+}
+
+bool PropertiesReader::readFile(const std::string& path, std::string *buffer) {
+    // Read, not mmap()ed: the config tool may truncate a file while we parse it.
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0) {
+        close(fd);
+        return false;
+    }
+
+    buffer->resize(file_stat.st_size);
+    size_t length = 0;
+    while (length < buffer->size()) {
+        ssize_t count = read(fd, &(*buffer)[length], buffer->size() - length);
+        if (count <= 0) break;
+        length += count;
+    }
+    buffer->resize(length);
+    close(fd);
+    return true;
+}
+
+std::string_view PropertiesReader::trim(std::string_view text) {
+    const char *whitespace = " \t\n\r\f\v";
+    size_t start = text.find_first_not_of(whitespace);
+    if (start == std::string_view::npos) return std::string_view();
+    size_t last = text.find_last_not_of(whitespace);
+    return text.substr(start, last - start + 1);
+}
+
+bool PropertiesReader::nextField(std::string_view &rest, std::string_view *field) {
+    if (rest.empty()) return false;
+    size_t comma = rest.find(',');
+    *field = trim(rest.substr(0, comma));
+    rest = comma == std::string_view::npos ? std::string_view() : rest.substr(comma + 1);
+    return true;
+}
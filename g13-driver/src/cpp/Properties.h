@@ -0,0 +1,82 @@
+#ifndef __PROPERTIES_H__
+#define __PROPERTIES_H__
+
+#include <charconv>
+#include <string>
+#include <string_view>
+
+/**
+ * @class PropertiesReader
+ * @brief Single-pass tokenizer for the key=value .properties files.
+ *
+ * Works in place on a buffer (see readFile()): keys, values and fields are
+ * string_views into it and numbers are read with std::from_chars, so
+ * parsing allocates nothing. Blank lines and '#' or '!' comments are skipped.
+ */
+class PropertiesReader {
+public:
+    /**
+     * @param text The file contents; must outlive the reader.
+     * @param source File name used in error messages.
+     */
+    PropertiesReader(std::string_view text, const char *source);
+
+    /**
+     * @brief Advances to the next key=value entry.
+     * @return false at the end of the text.
+     */
+    bool next();
+
+    /** @brief Key of the current entry, trimmed. */
+    std::string_view key() const;
+
+    /** @brief Value of the current entry, trimmed. */
+    std::string_view value() const;
+
+    /** @brief 1-based line number of the current entry. */
+    int line() const;
+
+    /**
+     * @brief Logs a problem with the current entry as "source:line: what 'token'".
+     */
+    void error(const char *what, std::string_view token) const;
+
+    /**
+     * @brief Reads a whole file into a buffer that is reused between calls.
+     * Once the buffer has grown to the largest file, reading allocates nothing.
+     * @return false if the file cannot be read.
+     */
+    static bool readFile(const std::string& path, std::string *buffer);
+
+    /** @brief Strips leading and trailing whitespace. */
+    static std::string_view trim(std::string_view text);
+
+    /**
+     * @brief Splits the next comma separated field off a value.
+     * @param rest The unparsed part of the value; advanced past the field.
+     * @param field Receives the trimmed field.
+     * @return false if there are no fields left.
+     */
+    static bool nextField(std::string_view &rest, std::string_view *field);
+
+    /**
+     * @brief Parses a whole field as a number.
+     * @return false unless the field is exactly one number of type T.
+     */
+    template <typename T>
+    static bool parseNumber(std::string_view text, T *value) {
+        const char *end = text.data() + text.size();
+        auto result = std::from_chars(text.data(), end, *value);
+        return !text.empty() && result.ec == std::errc() && result.ptr == end;
+    }
+
+private:
+    const char *cursor;
+    const char *end;
+    const char *source;
+    int line_number;
+    std::string_view current_key;
+    std::string_view current_value;
+};
+
+#endif // __PROPERTIES_H__
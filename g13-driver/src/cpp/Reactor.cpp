@@ -0,0 +1,216 @@
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <poll.h>
+#include <errno.h>
+#include <string.h>
+#include <syslog.h>
+
+#include "Reactor.h"
+
+#define REACTOR_MAX_EVENTS 16
+
+Reactor::Reactor()
+    : epoll_fd(-1), wake_fd(-1), keep_running(false), usb(nullptr), usb_handles_timeouts(true) {
+}
+
+Reactor::~Reactor() {
+    if (wake_fd >= 0) close(wake_fd);
+    if (epoll_fd >= 0) close(epoll_fd);
+}
+
+/**
+ * @brief Creates the epoll/eventfd pair and registers libusb's descriptors.
+ */
+bool Reactor::init(libusb_context *usb) {
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0) {
+        syslog(LOG_ERR, "Reactor: epoll_create1 failed: %s", strerror(errno));
+        return false;
+    }
+
+    wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd < 0 || !add(wake_fd, EPOLLIN, [this](uint32_t) {
+            uint64_t count;
+            if (::read(wake_fd, &count, sizeof(count)) < 0) {}
+        })) {
+        syslog(LOG_ERR, "Reactor: eventfd setup failed: %s", strerror(errno));
+        return false;
+    }
+
+    this->usb = usb;
+    const struct libusb_pollfd **pollfds = libusb_get_pollfds(usb);
+    if (!pollfds) {
+        syslog(LOG_ERR, "Reactor: libusb did not provide pollfds");
+        return false;
+    }
+    for (int i = 0; pollfds[i]; i++) {
+        pollfd_added(pollfds[i]->fd, pollfds[i]->events, this);
+    }
+    libusb_free_pollfds(pollfds);
+    libusb_set_pollfd_notifiers(usb, pollfd_added, pollfd_removed, this);
+
+    usb_handles_timeouts = libusb_pollfds_handle_timeouts(usb) != 0;
+
+    // Armed here, not in run(): a stop() that arrives while the reactor
+    // thread is still setting up must make run() return right away.
+    keep_running = true;
+    return true;
+}
+
+/**
+ * @brief The main loop. Sleeps in epoll_wait() until a descriptor is ready.
+ */
+void Reactor::run() {
+    struct epoll_event events[REACTOR_MAX_EVENTS];
+
+    while (keep_running) {
+        int count = epoll_wait(epoll_fd, events, REACTOR_MAX_EVENTS, next_timeout_ms());
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            syslog(LOG_ERR, "Reactor: epoll_wait failed: %s", strerror(errno));
+            break;
+        }
+
+        if (count == 0 && !usb_handles_timeouts) {
+            handle_usb_events(); // a libusb timeout expired
+        }
+
+        for (int i = 0; i < count; i++) {
+            Entry *entry = static_cast<Entry*>(events[i].data.ptr);
+            if (!entry->removed) {
+                entry->handler(events[i].events);
+            }
+        }
+        graveyard.clear();
+
+        run_posted_tasks();
+    }
+}
+
+void Reactor::stop() {
+    keep_running = false;
+    uint64_t one = 1;
+    if (wake_fd >= 0 && ::write(wake_fd, &one, sizeof(one)) < 0) {}
+}
+
+void Reactor::post(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(task_lock);
+        tasks.push_back(std::move(task));
+    }
+    uint64_t one = 1;
+    if (::write(wake_fd, &one, sizeof(one)) < 0) {}
+}
+
+void Reactor::run_posted_tasks() {
+    std::vector<Task> pending;
+    {
+        std::lock_guard<std::mutex> lock(task_lock);
+        pending.swap(tasks);
+    }
+    for (auto& task : pending) {
+        task();
+    }
+}
+
+bool Reactor::add(int fd, uint32_t events, Handler handler) {
+    auto entry = std::make_unique<Entry>();
+    entry->fd = fd;
+    entry->handler = std::move(handler);
+    entry->removed = false;
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.ptr = entry.get();
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        syslog(LOG_ERR, "Reactor: cannot watch fd %d: %s", fd, strerror(errno));
+        return false;
+    }
+
+    entries[fd] = std::move(entry);
+    return true;
+}
+
+void Reactor::remove(int fd) {
+    auto it = entries.find(fd);
+    if (it == entries.end()) return;
+
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+    // The entry may still be referenced by the epoll batch being dispatched.
+    it->second->removed = true;
+    graveyard.push_back(std::move(it->second));
+    entries.erase(it);
+}
+
+int Reactor::add_timer(int interval_ms, Task task) {
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0) {
+        syslog(LOG_ERR, "Reactor: timerfd_create failed: %s", strerror(errno));
+        return -1;
+    }
+
+    struct itimerspec spec;
+    spec.it_interval.tv_sec = interval_ms / 1000;
+    spec.it_interval.tv_nsec = (interval_ms % 1000) * 1000000L;
+    spec.it_value = spec.it_interval;
+    timerfd_settime(fd, 0, &spec, nullptr);
+
+    bool ok = add(fd, EPOLLIN, [fd, task](uint32_t) {
+        uint64_t expirations;
+        if (::read(fd, &expirations, sizeof(expirations)) == sizeof(expirations)) {
+            task();
+        }
+    });
+    if (!ok) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+void Reactor::remove_timer(int fd) {
+    if (fd < 0) return;
+    remove(fd);
+    close(fd);
+}
+
+libusb_context *Reactor::usb_context() const {
+    return usb;
+}
+
+/**
+ * @brief Lets libusb reap whatever made its descriptors ready, without blocking.
+ */
+void Reactor::handle_usb_events() {
+    struct timeval zero = { 0, 0 };
+    int error = libusb_handle_events_timeout_completed(usb, &zero, nullptr);
+    if (error && error != LIBUSB_ERROR_INTERRUPTED) {
+        syslog(LOG_ERR, "Error while handling USB events: %s", libusb_error_name(error));
+    }
+}
+
+/**
+ * @brief epoll timeout: infinite, unless libusb needs us to track its timeouts.
+ */
+int Reactor::next_timeout_ms() {
+    if (usb_handles_timeouts || !usb) return -1;
+
+    struct timeval tv;
+    if (libusb_get_next_timeout(usb, &tv) != 1) return -1;
+    return tv.tv_sec * 1000 + (tv.tv_usec + 999) / 1000;
+}
+
+void LIBUSB_CALL Reactor::pollfd_added(int fd, short events, void *user_data) {
+    Reactor *reactor = static_cast<Reactor*>(user_data);
+    uint32_t mask = 0;
+    if (events & POLLIN) mask |= EPOLLIN;
+    if (events & POLLOUT) mask |= EPOLLOUT;
+    reactor->add(fd, mask, [reactor](uint32_t) { reactor->handle_usb_events(); });
+}
+
+void LIBUSB_CALL Reactor::pollfd_removed(int fd, void *user_data) {
+    static_cast<Reactor*>(user_data)->remove(fd);
+}
@@ -0,0 +1,106 @@
+#ifndef __REACTOR_H__
+#define __REACTOR_H__
+
+#include <stdint.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <libusb-1.0/libusb.h>
+
+/**
+ * @class Reactor
+ * @brief A single epoll-based event loop shared by every G13 in the daemon.
+ *
+ * The reactor owns the libusb pollfds, each device's LCD FIFO, timers and any
+ * other descriptor registered with add(). Everything it dispatches runs on the
+ * thread that called run(), so device state needs no locking. The thread
+ * sleeps in epoll_wait() until one of those descriptors becomes ready.
+ */
+class Reactor {
+public:
+    /** Callback for a ready descriptor; receives the epoll event mask. */
+    typedef std::function<void(uint32_t events)> Handler;
+    /** Callback for timers and posted tasks. */
+    typedef std::function<void()> Task;
+
+    Reactor();
+    ~Reactor();
+
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+    /**
+     * @brief Creates the epoll instance and hooks in the libusb pollfds.
+     * @param usb The libusb context whose events this reactor handles.
+     * @return true on success, false on failure.
+     */
+    bool init(libusb_context *usb);
+
+    /** @brief Dispatches events until stop() is called; returns at once if it already was. */
+    void run();
+
+    /** @brief Asks run() to return, also if it has not started yet. Safe to call from any thread. */
+    void stop();
+
+    /**
+     * @brief Queues a task to run on the reactor thread after the current dispatch.
+     * Safe to call from any thread, including from inside libusb callbacks.
+     */
+    void post(Task task);
+
+    /**
+     * @brief Registers a descriptor with the loop. Reactor thread only.
+     * @param fd The descriptor to watch.
+     * @param events The epoll event mask (e.g., EPOLLIN).
+     * @param handler Called with the ready events.
+     * @return true on success, false on failure.
+     */
+    bool add(int fd, uint32_t events, Handler handler);
+
+    /** @brief Unregisters a descriptor. Does not close it. Reactor thread only. */
+    void remove(int fd);
+
+    /**
+     * @brief Creates a periodic timerfd and registers it with the loop.
+     * @param interval_ms The timer period in milliseconds.
+     * @param task Called once per expiry batch.
+     * @return The timer descriptor (used with remove_timer()), or -1 on failure.
+     */
+    int add_timer(int interval_ms, Task task);
+
+    /** @brief Unregisters and closes a timer created by add_timer(). */
+    void remove_timer(int fd);
+
+    /** @brief Gets the libusb context served by this reactor. */
+    libusb_context *usb_context() const;
+
+private:
+    struct Entry {
+        int fd;
+        Handler handler;
+        bool removed;
+    };
+
+    void handle_usb_events();
+    void run_posted_tasks();
+    int  next_timeout_ms();
+
+    static void LIBUSB_CALL pollfd_added(int fd, short events, void *user_data);
+    static void LIBUSB_CALL pollfd_removed(int fd, void *user_data);
+
+    int epoll_fd;
+    int wake_fd;                 // eventfd used by post() and stop()
+    volatile bool keep_running;
+    libusb_context *usb;
+    bool usb_handles_timeouts;   // false on platforms without timerfd support in libusb
+
+    std::unordered_map<int, std::unique_ptr<Entry>> entries;
+    std::vector<std::unique_ptr<Entry>> graveyard; // removed during dispatch, freed afterwards
+
+    std::mutex task_lock;
+    std::vector<Task> tasks;
+};
+
+#endif // __REACTOR_H__